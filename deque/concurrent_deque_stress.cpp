@@ -0,0 +1,195 @@
+// g++ -std=c++20 -O1 -g -fsanitize=thread concurrent_deque_stress.cpp -pthread
+// g++ -std=c++20 -O2 -DNDEBUG concurrent_deque_stress.cpp -pthread &&
+//     ./a.out bench
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "deque.hpp"
+
+void StressSpsc(size_t count) {
+  SpscDeque<size_t> deque(kIntCap);
+  std::thread producer([&] {
+    for (size_t i = 0; i < count; ++i) {
+      while (!deque.push_back(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  size_t expected = 0;
+  while (expected != count) {
+    size_t value;
+    if (deque.pop_front(value)) {
+      assert(value == expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  assert(deque.empty());
+}
+
+void StressWorkStealing(size_t count, size_t thieves) {
+  const size_t kBurst = 3 * kIntCap;
+  WorkStealingDeque<size_t> deque;
+  std::vector<std::atomic<unsigned char>> seen(count);
+  std::atomic<bool> done = false;
+  std::vector<size_t> sums(thieves + 1, 0);
+  std::vector<size_t> counts(thieves + 1, 0);
+  auto take = [&](size_t value, size_t owner) {
+    assert(value < count);
+    [[maybe_unused]] unsigned char times =
+        seen[value].fetch_add(1, std::memory_order_relaxed);
+    assert(times == 0);
+    sums[owner] += value;
+    ++counts[owner];
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t <= thieves; ++t) {
+    workers.emplace_back([&, t] {
+      size_t value;
+      while (!done.load(std::memory_order_acquire)) {
+        if (deque.steal_front(value)) {
+          take(value, t);
+        }
+      }
+      while (deque.steal_front(value)) {
+        take(value, t);
+      }
+    });
+  }
+  size_t next = 0;
+  while (next != count) {
+    for (size_t i = 0; i < kBurst && next != count; ++i) {
+      deque.push_back(next++);
+    }
+    size_t value;
+    for (size_t i = 0; i < kBurst / 2 && deque.pop_back(value); ++i) {
+      take(value, 0);
+    }
+  }
+  size_t value;
+  while (deque.pop_back(value)) {
+    take(value, 0);
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  assert(std::accumulate(counts.begin(), counts.end(), size_t(0)) == count);
+  assert(std::accumulate(sums.begin(), sums.end(), size_t(0)) ==
+         count * (count - 1) / 2);
+}
+
+class LockedDeque {
+ public:
+  void push_back(size_t value) {
+    std::lock_guard lock(mutex_);
+    deque_.push_back(value);
+  }
+
+  bool pop_back(size_t& value) {
+    std::lock_guard lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    value = deque_[deque_.size() - 1];
+    deque_.pop_back();
+    return true;
+  }
+
+  bool steal_front(size_t& value) {
+    std::lock_guard lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    value = deque_[0];
+    deque_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  Deque<size_t> deque_;
+};
+
+// Same owner/thief pattern as StressWorkStealing, without the per-element
+// bookkeeping, so the time is spent in the queue itself.
+template <typename Queue>
+double BenchWorkStealing(size_t count, size_t thieves) {
+  const size_t kBurst = 3 * kIntCap;
+  Queue queue;
+  std::atomic<bool> done = false;
+  std::vector<size_t> sums(thieves + 1, 0);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 1; t <= thieves; ++t) {
+    workers.emplace_back([&, t] {
+      size_t value;
+      size_t sum = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        if (queue.steal_front(value)) {
+          sum += value;
+        }
+      }
+      while (queue.steal_front(value)) {
+        sum += value;
+      }
+      sums[t] = sum;
+    });
+  }
+  size_t next = 0;
+  size_t value;
+  while (next != count) {
+    for (size_t i = 0; i < kBurst && next != count; ++i) {
+      queue.push_back(next++);
+    }
+    for (size_t i = 0; i < kBurst / 2 && queue.pop_back(value); ++i) {
+      sums[0] += value;
+    }
+  }
+  while (queue.pop_back(value)) {
+    sums[0] += value;
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  if (std::accumulate(sums.begin(), sums.end(), size_t(0)) !=
+      count * (count - 1) / 2) {
+    std::cerr << "lost elements\n";
+    std::abort();
+  }
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+void Bench() {
+  const size_t kCount = 1 << 22;
+  std::printf("%-8s %20s %20s\n", "thieves", "WorkStealing Mops/s",
+              "mutex Deque Mops/s");
+  for (size_t thieves : {0, 1, 2, 4, 8}) {
+    double lock_free = BenchWorkStealing<WorkStealingDeque<size_t>>(kCount,
+                                                                    thieves);
+    double locked = BenchWorkStealing<LockedDeque>(kCount, thieves);
+    std::printf("%-8zu %20.2f %20.2f\n", thieves, kCount / lock_free * 1e-6,
+                kCount / locked * 1e-6);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+    Bench();
+    return 0;
+  }
+  for (int round = 0; round < 4; ++round) {
+    StressSpsc(1 << 20);
+    StressWorkStealing(1 << 18, 4);
+  }
+  std::cout << "OK\n";
+}
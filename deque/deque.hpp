@@ -1,43 +1,34 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <numeric>
+#include <span>
 #include <vector>
 
 using my_pair = std::pair<size_t, size_t>;
 
-const size_t kIntCap = 10000;
-const size_t kOutCap = 10000;
+const size_t kIntShift = 13;
+const size_t kIntCap = size_t(1) << kIntShift;
+const size_t kIntMask = kIntCap - 1;
+const size_t kOutCap = 8;
+const size_t kSpareBlocks = 4;
 
 struct Utility {
-  static void move_pos_right(my_pair& pos) {
-    if (pos.second == kIntCap - 1) {
-      pos = {pos.first + 1, 0};
-    } else {
-      pos = {pos.first, pos.second + 1};
-    }
+  static size_t to_index(const my_pair& pos) {
+    return (pos.first << kIntShift) | pos.second;
   }
 
-  static void move_pos_left(my_pair& pos) {
-    if (pos.second == 0) {
-      pos = {pos.first - 1, kIntCap - 1};
-    } else {
-      pos = {pos.first, pos.second - 1};
-    }
+  static my_pair to_pos(size_t index) {
+    return {index >> kIntShift, index & kIntMask};
   }
 
-  static my_pair move_pos(const my_pair& pos, int value) {
-    my_pair new_pos = pos;
-    if (value >= 0) {
-      new_pos.first = pos.first + (pos.second + value) / kIntCap;
-      new_pos.second = (pos.second + value) % kIntCap;
-    } else {
-      size_t val = -value;
-      if (val <= pos.second) {
-        new_pos.second = new_pos.second - val;
-      } else {
-        new_pos.first = new_pos.first - (val - pos.second) / kIntCap - 1;
-        new_pos.second = kIntCap - (val - pos.second) % kIntCap;
-      }
-    }
-    return new_pos;
+  static void move_pos_right(my_pair& pos) { pos = to_pos(to_index(pos) + 1); }
+
+  static void move_pos_left(my_pair& pos) { pos = to_pos(to_index(pos) - 1); }
+
+  static my_pair move_pos(const my_pair& pos, std::ptrdiff_t value) {
+    return to_pos(to_index(pos) + value);
   }
 };
 
@@ -71,16 +62,21 @@ class Deque {
   Deque();
   Deque(const Allocator& alloc);
   Deque(const Deque& other);
+  Deque(const Deque& other, const Allocator& alloc);
   Deque(size_t count, const Allocator& alloc = Allocator());
   Deque(size_t count, const T& value, const Allocator& alloc = Allocator());
-  Deque(Deque&& other);
+  Deque(Deque&& other) noexcept;
+  Deque(Deque&& other, const Allocator& alloc);
   Deque(std::initializer_list<T> init, const Allocator& alloc = Allocator());
   ~Deque();
 
   void reallocate();
+  void shrink_to_fit();
 
   Deque& operator=(const Deque& other);
-  Deque&& operator=(Deque&& other);
+  Deque& operator=(Deque&& other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value);
 
   size_t size() const;
   bool empty() const;
@@ -110,18 +106,28 @@ class Deque {
 
   void erase(iterator iter);
 
-  void swap(Deque& other);
+  void swap(Deque& other) noexcept;
   void clear() noexcept;
 
   Allocator& get_allocator();
 
  private:
+  T* const* table() const;
+  void init_table(size_t count);
+  void steal(Deque& other) noexcept;
+  void acquire_block(size_t block);
+  void release_block(size_t block) noexcept;
+  void release_storage() noexcept;
+
   Allocator alloc_;
   std::vector<T*> arr_;
-  size_t out_cap_ = kOutCap;
+  std::array<T*, kSpareBlocks> spare_;
+  size_t spare_count_ = 0;
+  size_t out_cap_ = 0;
   size_t int_cap_ = kIntCap;
-  my_pair start_pos_;
-  my_pair end_pos_;
+  static constexpr T* kEmptyTable[1] = {nullptr};
+  my_pair start_pos_ = {0, kIntCap / 2};
+  my_pair end_pos_ = {0, kIntCap / 2 - 1};
 };
 
 template <typename T, typename Allocator>
@@ -134,20 +140,25 @@ class Deque<T, Allocator>::CommonIterator {
   using reference = std::conditional_t<IsConst, const T, T>&;
   using difference_type = std::ptrdiff_t;
 
-  CommonIterator(std::conditional_t<IsConst, const Deque, Deque>* obj,
-                 my_pair curr_pos)
-      : deque_(obj), curr_pos_(curr_pos) {}
+  CommonIterator(T* const* blocks, size_t index)
+      : blocks_(blocks), block_(blocks[index >> kIntShift]), index_(index) {}
 
-  reference operator*() const {
-    return deque_->arr_[curr_pos_.first][curr_pos_.second];
-  }
+  operator CommonIterator<true>() const { return {blocks_, index_}; }
 
-  pointer operator->() const {
-    return &deque_->arr_[curr_pos_.first][curr_pos_.second];
+  reference operator*() const { return block_[index_ & kIntMask]; }
+
+  pointer operator->() const { return block_ + (index_ & kIntMask); }
+
+  reference operator[](difference_type value) const {
+    size_t index = index_ + value;
+    return blocks_[index >> kIntShift][index & kIntMask];
   }
 
   CommonIterator& operator++() {
-    Utility::move_pos_right(curr_pos_);
+    ++index_;
+    if ((index_ & kIntMask) == 0) {
+      block_ = blocks_[index_ >> kIntShift];
+    }
     return *this;
   }
 
@@ -158,7 +169,10 @@ class Deque<T, Allocator>::CommonIterator {
   }
 
   CommonIterator& operator--() {
-    Utility::move_pos_left(curr_pos_);
+    if ((index_ & kIntMask) == 0) {
+      block_ = blocks_[(index_ - 1) >> kIntShift];
+    }
+    --index_;
     return *this;
   }
 
@@ -168,158 +182,221 @@ class Deque<T, Allocator>::CommonIterator {
     return prev;
   }
 
-  CommonIterator& operator+=(int value) {
-    curr_pos_ = Utility::move_pos(curr_pos_, value);
+  CommonIterator& operator+=(difference_type value) {
+    index_ += value;
+    block_ = blocks_[index_ >> kIntShift];
     return *this;
   }
 
-  CommonIterator operator+(int value) const {
+  CommonIterator operator+(difference_type value) const {
     CommonIterator copy = *this;
     copy += value;
     return copy;
   }
 
-  CommonIterator& operator-=(int value) {
-    curr_pos_ = Utility::move_pos(curr_pos_, -value);
-    return *this;
+  friend CommonIterator operator+(difference_type value,
+                                  const CommonIterator& iter) {
+    return iter + value;
   }
 
-  CommonIterator operator-(int value) const {
+  CommonIterator& operator-=(difference_type value) {
+    return operator+=(-value);
+  }
+
+  CommonIterator operator-(difference_type value) const {
     CommonIterator copy = *this;
     copy -= value;
     return copy;
   }
 
   difference_type operator-(const CommonIterator& other) const {
-    return deque_->int_cap_ * (curr_pos_.first - other.curr_pos_.first) +
-           curr_pos_.second - other.curr_pos_.second;
+    return static_cast<difference_type>(index_ - other.index_);
+  }
+
+  std::span<value_type> segment(const CommonIterator& last) const {
+    size_t stop = std::min((index_ | kIntMask) + 1, last.index_);
+    return {block_ + (index_ & kIntMask), stop - index_};
   }
 
   bool operator<(const CommonIterator& other) const {
-    if (curr_pos_.first == other.curr_pos_.first) {
-      return curr_pos_.second < other.curr_pos_.second;
-    }
-    return curr_pos_.first < other.curr_pos_.first;
+    return index_ < other.index_;
   }
 
   bool operator>(const CommonIterator& other) const {
-    if (curr_pos_.first == other.curr_pos_.first) {
-      return curr_pos_.second > other.curr_pos_.second;
-    }
-    return curr_pos_.first > other.curr_pos_.first;
+    return index_ > other.index_;
   }
 
   bool operator<=(const CommonIterator& other) const {
-    return !(*this > other);
+    return index_ <= other.index_;
   }
 
   bool operator>=(const CommonIterator& other) const {
-    return !(*this < other);
+    return index_ >= other.index_;
   }
 
   bool operator==(const CommonIterator& other) const {
-    return (!(*this < other) && !(*this > other));
+    return index_ == other.index_;
   }
 
   bool operator!=(const CommonIterator& other) const {
-    return ((*this < other) || (*this > other));
+    return index_ != other.index_;
   }
 
  private:
-  std::conditional_t<IsConst, const Deque, Deque>* deque_;
-  my_pair curr_pos_;
+  T* const* blocks_;
+  pointer block_;
+  size_t index_;
 };
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque() {
-  alloc_ = Allocator();
-  arr_.assign(out_cap_, nullptr);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
+struct Segmented {
+  template <typename Iter>
+  static constexpr bool kIsSegmented =
+      requires(const Iter& iter) { iter.segment(iter); };
+
+  template <typename Iter, typename Func>
+  static void for_each_segment(Iter first, Iter last, Func func) {
+    while (first != last) {
+      auto segment = first.segment(last);
+      func(segment);
+      first += segment.size();
+    }
   }
-  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
-  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
-}
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(const Allocator& alloc) {
-  alloc_ = alloc;
-  arr_.assign(out_cap_, nullptr);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
+  template <typename Iter, typename Func>
+  static Func for_each(Iter first, Iter last, Func func) {
+    if constexpr (kIsSegmented<Iter>) {
+      for_each_segment(first, last, [&func](auto segment) {
+        for (auto& elem : segment) {
+          func(elem);
+        }
+      });
+      return func;
+    } else {
+      return std::for_each(first, last, func);
+    }
   }
-  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
-  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
-}
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(const Deque& other) {
-  out_cap_ = other.out_cap_;
-  arr_.assign(out_cap_, nullptr);
-  alloc_ = alloc_traits::select_on_container_copy_construction(other.alloc_);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
+  template <typename Iter, typename OutIter>
+  static OutIter copy(Iter first, Iter last, OutIter out) {
+    if constexpr (kIsSegmented<Iter>) {
+      for_each_segment(first, last, [&out](auto segment) {
+        out = copy(segment.begin(), segment.end(), out);
+      });
+      return out;
+    } else if constexpr (kIsSegmented<OutIter>) {
+      while (first != last) {
+        auto segment = out.segment(out + std::distance(first, last));
+        auto next = std::next(first, segment.size());
+        std::copy(first, next, segment.begin());
+        first = next;
+        out += segment.size();
+      }
+      return out;
+    } else {
+      return std::copy(first, last, out);
+    }
   }
-  start_pos_ = other.start_pos_;
-  end_pos_ = start_pos_;
-  Utility::move_pos_left(end_pos_);
+
+  template <typename Iter, typename U>
+  static void fill(Iter first, Iter last, const U& value) {
+    if constexpr (kIsSegmented<Iter>) {
+      for_each_segment(first, last, [&value](auto segment) {
+        std::fill(segment.begin(), segment.end(), value);
+      });
+    } else {
+      std::fill(first, last, value);
+    }
+  }
+
+  template <typename Iter, typename U>
+  static Iter find(Iter first, Iter last, const U& value) {
+    if constexpr (kIsSegmented<Iter>) {
+      while (first != last) {
+        auto segment = first.segment(last);
+        auto found = std::find(segment.begin(), segment.end(), value);
+        first += found - segment.begin();
+        if (found != segment.end()) {
+          return first;
+        }
+      }
+      return last;
+    } else {
+      return std::find(first, last, value);
+    }
+  }
+
+  template <typename Iter, typename U>
+  static U accumulate(Iter first, Iter last, U init) {
+    if constexpr (kIsSegmented<Iter>) {
+      for_each_segment(first, last, [&init](auto segment) {
+        init = std::accumulate(segment.begin(), segment.end(), std::move(init));
+      });
+      return init;
+    } else {
+      return std::accumulate(first, last, std::move(init));
+    }
+  }
+};
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque() : Deque(Allocator()) {}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(const Allocator& alloc) : alloc_(alloc) {}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(const Deque& other)
+    : Deque(other,
+            alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(const Deque& other, const Allocator& alloc)
+    : alloc_(alloc) {
+  init_table(other.size());
   try {
-    for (size_t i = 0; i < other.size(); ++i) {
-      alloc_traits::construct(alloc_, &operator[](i), other[i]);
-      Utility::move_pos_right(end_pos_);
+    for (const auto& elem : other) {
+      emplace_back(elem);
     }
   } catch (...) {
-    clear();
+    release_storage();
     throw;
   }
 }
 
 template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(size_t count, const Allocator& alloc) {
-  alloc_ = alloc;
-  out_cap_ = std::max(out_cap_, count * 4 / int_cap_);
-  arr_.assign(out_cap_, nullptr);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
-  }
-  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
-  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
+Deque<T, Allocator>::Deque(size_t count, const Allocator& alloc)
+    : alloc_(alloc) {
+  init_table(count);
   try {
     for (size_t i = 0; i < count; ++i) {
-      alloc_traits::construct(alloc_, &operator[](i));
-      Utility::move_pos_right(end_pos_);
+      emplace_back();
     }
   } catch (...) {
-    clear();
+    release_storage();
     throw;
   }
 }
 
 template <typename T, typename Allocator>
 Deque<T, Allocator>::Deque(size_t count, const T& value,
-                           const Allocator& alloc) {
-  alloc_ = alloc;
-  out_cap_ = std::max(out_cap_, count * 4 / int_cap_);
-  arr_.assign(out_cap_, nullptr);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
-  }
-  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
-  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
+                           const Allocator& alloc)
+    : alloc_(alloc) {
+  init_table(count);
   try {
     for (size_t i = 0; i < count; ++i) {
-      alloc_traits::construct(alloc_, &operator[](i), value);
-      Utility::move_pos_right(end_pos_);
+      emplace_back(value);
     }
   } catch (...) {
-    clear();
+    release_storage();
     throw;
   }
 }
 
 template <typename T, typename Allocator>
-void Deque<T, Allocator>::swap(Deque<T, Allocator>& other) {
+void Deque<T, Allocator>::swap(Deque<T, Allocator>& other) noexcept {
   std::swap(arr_, other.arr_);
+  std::swap(spare_, other.spare_);
+  std::swap(spare_count_, other.spare_count_);
   std::swap(alloc_, other.alloc_);
   std::swap(start_pos_, other.start_pos_);
   std::swap(end_pos_, other.end_pos_);
@@ -327,29 +404,41 @@ void Deque<T, Allocator>::swap(Deque<T, Allocator>& other) {
 }
 
 template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(Deque&& other) : Deque() {
-  swap(other);
+Deque<T, Allocator>::Deque(Deque&& other) noexcept
+    : alloc_(std::move(other.alloc_)) {
+  steal(other);
 }
 
 template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(std::initializer_list<T> init,
-                           const Allocator& alloc) {
-  alloc_ = alloc;
-  out_cap_ = std::max(out_cap_, init.size() * 4 / int_cap_);
-  arr_.assign(out_cap_, nullptr);
-  for (size_t i = 0; i < out_cap_; ++i) {
-    arr_[i] = alloc_traits::allocate(alloc_, int_cap_);
+Deque<T, Allocator>::Deque(Deque&& other, const Allocator& alloc)
+    : alloc_(alloc) {
+  if (alloc_ == other.alloc_) {
+    steal(other);
+    return;
   }
-  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
-  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
-  int index = 0;
+  init_table(other.size());
+  try {
+    for (auto& elem : other) {
+      emplace_back(std::move(elem));
+    }
+  } catch (...) {
+    release_storage();
+    throw;
+  }
+  other.clear();
+}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(std::initializer_list<T> init,
+                           const Allocator& alloc)
+    : alloc_(alloc) {
+  init_table(init.size());
   try {
     for (const auto& elem : init) {
-      alloc_traits::construct(alloc_, &operator[](index++), elem);
-      Utility::move_pos_right(end_pos_);
+      emplace_back(elem);
     }
   } catch (...) {
-    clear();
+    release_storage();
     throw;
   }
 }
@@ -360,59 +449,144 @@ Deque<T, Allocator>& Deque<T, Allocator>::operator=(
   if (this == &other) {
     return *this;
   }
-  Deque copy(other);
+  Deque copy(other,
+             alloc_traits::propagate_on_container_copy_assignment::value
+                 ? other.alloc_
+                 : alloc_);
   swap(copy);
-  if (alloc_traits::propagate_on_container_copy_assignment::value) {
-    alloc_ = other.alloc_;
-  }
   return *this;
 }
 
 template <typename T, typename Allocator>
-Deque<T, Allocator>&& Deque<T, Allocator>::operator=(
-    Deque<T, Allocator>&& other) {
+Deque<T, Allocator>& Deque<T, Allocator>::operator=(
+    Deque<T, Allocator>&& other) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value) {
   if (this == &other) {
-    return std::move(*this);
+    return *this;
   }
-  swap(other);
-  if (alloc_traits::propagate_on_container_copy_assignment::value) {
-    alloc_ = other.alloc_;
+  if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+    release_storage();
+    alloc_ = std::move(other.alloc_);
+    steal(other);
+  } else {
+    if (alloc_ == other.alloc_) {
+      release_storage();
+      steal(other);
+    } else {
+      clear();
+      for (auto& elem : other) {
+        emplace_back(std::move(elem));
+      }
+      other.clear();
+    }
   }
-  return std::move(*this);
+  return *this;
 }
+
+template <typename T, typename Allocator>
+T* const* Deque<T, Allocator>::table() const {
+  return arr_.empty() ? kEmptyTable : arr_.data();
+}
+
+template <typename T, typename Allocator>
+void Deque<T, Allocator>::init_table(size_t count) {
+  out_cap_ = std::max(kOutCap, count * 4 / int_cap_);
+  arr_.assign(out_cap_, nullptr);
+  start_pos_ = {out_cap_ / 2, int_cap_ / 2};
+  end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
+}
+
+template <typename T, typename Allocator>
+void Deque<T, Allocator>::steal(Deque& other) noexcept {
+  arr_ = std::move(other.arr_);
+  spare_ = other.spare_;
+  spare_count_ = other.spare_count_;
+  out_cap_ = other.out_cap_;
+  start_pos_ = other.start_pos_;
+  end_pos_ = other.end_pos_;
+  other.arr_.clear();
+  other.spare_count_ = 0;
+  other.out_cap_ = 0;
+  other.start_pos_ = {0, int_cap_ / 2};
+  other.end_pos_ = {0, int_cap_ / 2 - 1};
+}
+
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::reallocate() {
-  size_t new_out_cap = out_cap_ * 2;
-  std::vector<T*> new_arr(new_out_cap);
-  for (size_t i = 0; i < new_out_cap; ++i) {
-    new_arr[i] = alloc_traits::allocate(alloc_, int_cap_);
-  }
-  my_pair new_start_pos = {start_pos_.first + out_cap_ / 2, start_pos_.second};
-  my_pair new_end_pos = {end_pos_.first + out_cap_ / 2, end_pos_.second};
-  my_pair curr_pos = new_start_pos;
-  try {
-    for (size_t i = 0; i < size(); ++i) {
-      alloc_traits::construct(alloc_, &new_arr[curr_pos.first][curr_pos.second],
-                              std::move(operator[](i)));
-      Utility::move_pos_right(curr_pos);
-    }
-  } catch (...) {
-    curr_pos = new_start_pos;
-    for (size_t i = 0; i < size(); ++i) {
-      alloc_traits::destroy(alloc_, &new_arr[curr_pos.first][curr_pos.second]);
-      Utility::move_pos_right(curr_pos);
+  size_t first_block = start_pos_.first;
+  size_t used = empty() ? 1 : end_pos_.first + 1 - first_block;
+  if (out_cap_ != 0 && 2 * used <= out_cap_) {
+    size_t offset = (out_cap_ - used) / 2;
+    if (offset < first_block) {
+      std::rotate(arr_.begin() + offset, arr_.begin() + first_block,
+                  arr_.end());
+    } else {
+      std::rotate(arr_.begin(), arr_.end() - (offset - first_block),
+                  arr_.end());
     }
-    for (size_t i = 0; i < out_cap_; ++i) {
-      alloc_traits::deallocate(alloc_, new_arr[i], int_cap_);
+    start_pos_.first = start_pos_.first + offset - first_block;
+    end_pos_.first = end_pos_.first + offset - first_block;
+    return;
+  }
+  size_t new_out_cap = std::max(out_cap_ * 2, kOutCap);
+  size_t shift = (new_out_cap - out_cap_) / 2;
+  std::vector<T*> new_arr(new_out_cap, nullptr);
+  std::copy(arr_.begin(), arr_.end(), new_arr.begin() + shift);
+  start_pos_.first += shift;
+  end_pos_.first += shift;
+  arr_.swap(new_arr);
+  out_cap_ = new_out_cap;
+}
+
+template <typename T, typename Allocator>
+void Deque<T, Allocator>::shrink_to_fit() {
+  for (size_t i = 0; i < spare_count_; ++i) {
+    alloc_traits::deallocate(alloc_, spare_[i], int_cap_);
+  }
+  spare_count_ = 0;
+  size_t first_block = start_pos_.first;
+  size_t used = end_pos_.first + 1 - first_block;
+  for (size_t i = 0; i < out_cap_; ++i) {
+    if (arr_[i] != nullptr && (i < first_block || i >= first_block + used)) {
+      alloc_traits::deallocate(alloc_, arr_[i], int_cap_);
+      arr_[i] = nullptr;
     }
-    clear();
-    throw;
   }
-  clear();
-  arr_ = new_arr;
+  size_t new_out_cap = std::max({2 * used, used + 2, size_t(4)});
+  if (new_out_cap >= out_cap_) {
+    return;
+  }
+  size_t offset = (new_out_cap - used) / 2;
+  std::vector<T*> new_arr(new_out_cap, nullptr);
+  std::copy(arr_.begin() + first_block, arr_.begin() + first_block + used,
+            new_arr.begin() + offset);
+  start_pos_.first = start_pos_.first + offset - first_block;
+  end_pos_.first = end_pos_.first + offset - first_block;
+  arr_.swap(new_arr);
   out_cap_ = new_out_cap;
-  start_pos_ = new_start_pos;
-  end_pos_ = new_end_pos;
+}
+
+template <typename T, typename Allocator>
+void Deque<T, Allocator>::acquire_block(size_t block) {
+  if (arr_[block] != nullptr) {
+    return;
+  }
+  if (spare_count_ != 0) {
+    arr_[block] = spare_[--spare_count_];
+  } else {
+    arr_[block] = alloc_traits::allocate(alloc_, int_cap_);
+  }
+}
+
+template <typename T, typename Allocator>
+void Deque<T, Allocator>::release_block(size_t block) noexcept {
+  if (spare_count_ != kSpareBlocks) {
+    spare_[spare_count_++] = arr_[block];
+  } else {
+    alloc_traits::deallocate(alloc_, arr_[block], int_cap_);
+  }
+  arr_[block] = nullptr;
 }
 
 template <typename T, typename Allocator>
@@ -421,54 +595,58 @@ void Deque<T, Allocator>::clear() noexcept {
     alloc_traits::destroy(alloc_, &operator[](i));
   }
   for (size_t i = 0; i < out_cap_; ++i) {
-    alloc_traits::deallocate(alloc_, arr_[i], int_cap_);
+    if (arr_[i] != nullptr) {
+      release_block(i);
+    }
   }
   start_pos_ = {out_cap_ / 2, int_cap_ / 2};
   end_pos_ = {out_cap_ / 2, int_cap_ / 2 - 1};
-  out_cap_ = 0;
 }
 
 template <typename T, typename Allocator>
-Deque<T, Allocator>::~Deque() {
+void Deque<T, Allocator>::release_storage() noexcept {
   clear();
+  for (size_t i = 0; i < spare_count_; ++i) {
+    alloc_traits::deallocate(alloc_, spare_[i], int_cap_);
+  }
+  spare_count_ = 0;
+}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::~Deque() {
+  release_storage();
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::iterator Deque<T, Allocator>::begin() {
-  return iterator(this, start_pos_);
+  return iterator(table(), Utility::to_index(start_pos_));
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::iterator Deque<T, Allocator>::end() {
-  my_pair pos = end_pos_;
-  Utility::move_pos_right(pos);
-  return iterator(this, pos);
+  return iterator(table(), Utility::to_index(end_pos_) + 1);
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::begin()
     const {
-  return const_iterator(this, start_pos_);
+  return const_iterator(table(), Utility::to_index(start_pos_));
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::end() const {
-  my_pair pos = end_pos_;
-  Utility::move_pos_right(pos);
-  return const_iterator(this, pos);
+  return const_iterator(table(), Utility::to_index(end_pos_) + 1);
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cbegin()
     const {
-  return const_iterator(this, start_pos_);
+  return const_iterator(table(), Utility::to_index(start_pos_));
 }
 
 template <typename T, typename Allocator>
 typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cend() const {
-  my_pair pos = end_pos_;
-  Utility::move_pos_right(pos);
-  return const_iterator(this, pos);
+  return const_iterator(table(), Utility::to_index(end_pos_) + 1);
 }
 
 template <typename T, typename Allocator>
@@ -506,14 +684,14 @@ bool Deque<T, Allocator>::empty() const {
 
 template <typename T, typename Allocator>
 T& Deque<T, Allocator>::operator[](size_t val) {
-  my_pair pos = Utility::move_pos(start_pos_, val);
-  return arr_[pos.first][pos.second];
+  size_t index = Utility::to_index(start_pos_) + val;
+  return arr_[index >> kIntShift][index & kIntMask];
 }
 
 template <typename T, typename Allocator>
 const T& Deque<T, Allocator>::operator[](size_t val) const {
-  my_pair pos = Utility::move_pos(start_pos_, val);
-  return arr_[pos.first][pos.second];
+  size_t index = Utility::to_index(start_pos_) + val;
+  return arr_[index >> kIntShift][index & kIntMask];
 }
 
 template <typename T, typename Allocator>
@@ -534,76 +712,36 @@ const T& Deque<T, Allocator>::at(size_t val) const {
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::push_back(const T& elem) {
-  if (end_pos_.first == out_cap_ - 1) {
-    reallocate();
-  }
-  try {
-    alloc_traits::construct(alloc_, &operator[](size()), elem);
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](size()));
-    throw;
-  }
-  Utility::move_pos_right(end_pos_);
+  emplace_back(elem);
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::push_back(T&& elem) {
-  if (end_pos_.first == out_cap_ - 1) {
-    reallocate();
-  }
-  try {
-    alloc_traits::construct(alloc_, &operator[](size()), std::move(elem));
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](size()));
-    throw;
-  }
-  Utility::move_pos_right(end_pos_);
+  emplace_back(std::move(elem));
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::push_front(const T& elem) {
-  if (start_pos_.first == 0) {
-    reallocate();
-  }
-  Utility::move_pos_left(start_pos_);
-  try {
-    alloc_traits::construct(alloc_, &operator[](0), elem);
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](0));
-    Utility::move_pos_right(end_pos_);
-    throw;
-  }
+  emplace_front(elem);
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::push_front(T&& elem) {
-  if (start_pos_.first == 0) {
-    reallocate();
-  }
-  Utility::move_pos_left(start_pos_);
-  try {
-    alloc_traits::construct(alloc_, &operator[](0), std::move(elem));
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](0));
-    Utility::move_pos_right(end_pos_);
-    throw;
-  }
+  emplace_front(std::move(elem));
 }
 
 template <typename T, typename Allocator>
 template <typename... Args>
 void Deque<T, Allocator>::emplace_back(Args&&... args) {
-  if (end_pos_.first == out_cap_ - 1) {
+  if (end_pos_.first + 1 >= out_cap_) {
     reallocate();
   }
-  try {
-    alloc_traits::construct(alloc_, &operator[](size()),
-                            std::forward<Args>(args)...);
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](size()));
-    throw;
-  }
-  Utility::move_pos_right(end_pos_);
+  my_pair pos = end_pos_;
+  Utility::move_pos_right(pos);
+  acquire_block(pos.first);
+  alloc_traits::construct(alloc_, arr_[pos.first] + pos.second,
+                          std::forward<Args>(args)...);
+  end_pos_ = pos;
 }
 
 template <typename T, typename Allocator>
@@ -612,69 +750,394 @@ void Deque<T, Allocator>::emplace_front(Args&&... args) {
   if (start_pos_.first == 0) {
     reallocate();
   }
-  Utility::move_pos_left(start_pos_);
-  try {
-    alloc_traits::construct(alloc_, &operator[](0),
-                            std::forward<Args>(args)...);
-  } catch (...) {
-    alloc_traits::destroy(alloc_, &operator[](0));
-    Utility::move_pos_right(end_pos_);
-    throw;
-  }
+  my_pair pos = start_pos_;
+  Utility::move_pos_left(pos);
+  acquire_block(pos.first);
+  alloc_traits::construct(alloc_, arr_[pos.first] + pos.second,
+                          std::forward<Args>(args)...);
+  start_pos_ = pos;
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::pop_back() {
-  alloc_traits::destroy(alloc_, &operator[](size() - 1));
+  size_t block = end_pos_.first;
+  alloc_traits::destroy(alloc_, arr_[block] + end_pos_.second);
   Utility::move_pos_left(end_pos_);
+  if (end_pos_.first != block) {
+    release_block(block);
+  }
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::pop_front() {
-  alloc_traits::destroy(alloc_, &operator[](0));
+  size_t block = start_pos_.first;
+  alloc_traits::destroy(alloc_, arr_[block] + start_pos_.second);
   Utility::move_pos_right(start_pos_);
+  if (start_pos_.first != block) {
+    release_block(block);
+  }
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::insert(Deque<T, Allocator>::iterator iter,
                                  const T& value) {
-  auto new_iter = iter;
-  if (end_pos_.first == out_cap_ - 1) {
-    reallocate();
-    new_iter += int_cap_ * out_cap_ / 4;
-  }
-  push_back(value);
-  while (new_iter != end()) {
-    std::swap(*new_iter, operator[](size() - 1));
-    ++new_iter;
-  }
+  emplace(iter, value);
 }
 
 template <typename T, typename Allocator>
 template <typename... Args>
 void Deque<T, Allocator>::emplace(iterator iter, Args&&... args) {
-  auto new_iter = iter;
-  if (end_pos_.first == out_cap_ - 1) {
-    reallocate();
-    new_iter += int_cap_ * out_cap_ / 4;
+  size_t index = iter - begin();
+  if (index == 0) {
+    emplace_front(std::forward<Args>(args)...);
+    return;
   }
-  emplace_back(args...);
-  while (new_iter != end()) {
-    std::swap(*new_iter, operator[](size() - 1));
-    ++new_iter;
+  if (index == size()) {
+    emplace_back(std::forward<Args>(args)...);
+    return;
   }
+  T value(std::forward<Args>(args)...);
+  if (index < size() / 2) {
+    emplace_front(std::move(operator[](0)));
+    std::move(begin() + 2, begin() + index + 1, begin() + 1);
+  } else {
+    emplace_back(std::move(operator[](size() - 1)));
+    std::move_backward(begin() + index, end() - 2, end() - 1);
+  }
+  operator[](index) = std::move(value);
 }
 
 template <typename T, typename Allocator>
 void Deque<T, Allocator>::erase(iterator iter) {
-  while (iter + 1 < end()) {
-    std::swap(*iter, *(iter + 1));
-    ++iter;
+  size_t index = iter - begin();
+  if (index < size() / 2) {
+    std::move_backward(begin(), iter, iter + 1);
+    pop_front();
+  } else {
+    std::move(iter + 1, end(), iter);
+    pop_back();
   }
-  pop_back();
 }
 
 template <typename T, typename Allocator>
 Allocator& Deque<T, Allocator>::get_allocator() {
   return alloc_;
 }
+
+template <typename T, typename Allocator = std::allocator<T>>
+class SpscDeque {
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  explicit SpscDeque(size_t capacity, const Allocator& alloc = Allocator());
+  SpscDeque(const SpscDeque& other) = delete;
+  SpscDeque& operator=(const SpscDeque& other) = delete;
+  ~SpscDeque();
+
+  size_t capacity() const;
+  size_t size() const;
+  bool empty() const;
+
+  bool push_back(const T& elem);
+  bool push_back(T&& elem);
+
+  template <typename... Args>
+  bool emplace_back(Args&&... args);
+
+  bool pop_front(T& elem);
+
+ private:
+  T* slot(size_t index) const;
+
+  Allocator alloc_;
+  std::vector<T*> arr_;
+  size_t out_cap_;
+  size_t index_mask_;
+  alignas(64) std::atomic<size_t> start_index_ = 0;
+  size_t cached_end_index_ = 0;
+  alignas(64) std::atomic<size_t> end_index_ = 0;
+  size_t cached_start_index_ = 0;
+};
+
+template <typename T, typename Allocator>
+SpscDeque<T, Allocator>::SpscDeque(size_t capacity, const Allocator& alloc)
+    : alloc_(alloc) {
+  out_cap_ = 1;
+  while ((out_cap_ << kIntShift) < capacity) {
+    out_cap_ <<= 1;
+  }
+  index_mask_ = (out_cap_ << kIntShift) - 1;
+  arr_.assign(out_cap_, nullptr);
+  try {
+    for (size_t i = 0; i < out_cap_; ++i) {
+      arr_[i] = alloc_traits::allocate(alloc_, kIntCap);
+    }
+  } catch (...) {
+    for (size_t i = 0; i < out_cap_ && arr_[i] != nullptr; ++i) {
+      alloc_traits::deallocate(alloc_, arr_[i], kIntCap);
+    }
+    throw;
+  }
+}
+
+template <typename T, typename Allocator>
+SpscDeque<T, Allocator>::~SpscDeque() {
+  size_t end_index = end_index_.load(std::memory_order_relaxed);
+  for (size_t i = start_index_.load(std::memory_order_relaxed);
+       i != end_index; ++i) {
+    alloc_traits::destroy(alloc_, slot(i));
+  }
+  for (size_t i = 0; i < out_cap_; ++i) {
+    alloc_traits::deallocate(alloc_, arr_[i], kIntCap);
+  }
+}
+
+template <typename T, typename Allocator>
+T* SpscDeque<T, Allocator>::slot(size_t index) const {
+  index &= index_mask_;
+  return arr_[index >> kIntShift] + (index & kIntMask);
+}
+
+template <typename T, typename Allocator>
+size_t SpscDeque<T, Allocator>::capacity() const {
+  return index_mask_ + 1;
+}
+
+template <typename T, typename Allocator>
+size_t SpscDeque<T, Allocator>::size() const {
+  return end_index_.load(std::memory_order_acquire) -
+         start_index_.load(std::memory_order_acquire);
+}
+
+template <typename T, typename Allocator>
+bool SpscDeque<T, Allocator>::empty() const {
+  return size() == 0;
+}
+
+template <typename T, typename Allocator>
+bool SpscDeque<T, Allocator>::push_back(const T& elem) {
+  return emplace_back(elem);
+}
+
+template <typename T, typename Allocator>
+bool SpscDeque<T, Allocator>::push_back(T&& elem) {
+  return emplace_back(std::move(elem));
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+bool SpscDeque<T, Allocator>::emplace_back(Args&&... args) {
+  size_t end_index = end_index_.load(std::memory_order_relaxed);
+  if (end_index - cached_start_index_ == capacity()) {
+    cached_start_index_ = start_index_.load(std::memory_order_acquire);
+    if (end_index - cached_start_index_ == capacity()) {
+      return false;
+    }
+  }
+  alloc_traits::construct(alloc_, slot(end_index), std::forward<Args>(args)...);
+  end_index_.store(end_index + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Allocator>
+bool SpscDeque<T, Allocator>::pop_front(T& elem) {
+  size_t start_index = start_index_.load(std::memory_order_relaxed);
+  if (start_index == cached_end_index_) {
+    cached_end_index_ = end_index_.load(std::memory_order_acquire);
+    if (start_index == cached_end_index_) {
+      return false;
+    }
+  }
+  T* ptr = slot(start_index);
+  elem = std::move(*ptr);
+  alloc_traits::destroy(alloc_, ptr);
+  start_index_.store(start_index + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Allocator = std::allocator<T>>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "stolen elements are read racily and must be copyable as bytes");
+
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+
+  explicit WorkStealingDeque(size_t capacity = kIntCap,
+                             const Allocator& alloc = Allocator());
+  WorkStealingDeque(const WorkStealingDeque& other) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+  ~WorkStealingDeque();
+
+  size_t size() const;
+  bool empty() const;
+
+  void push_back(const T& elem);
+  bool pop_back(T& elem);
+  bool steal_front(T& elem);
+
+ private:
+  struct Ring;
+
+  using slot_type = std::atomic<T>;
+  using slot_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<slot_type>;
+  using slot_alloc_traits = std::allocator_traits<slot_alloc>;
+  using ring_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Ring>;
+  using ring_alloc_traits = std::allocator_traits<ring_alloc>;
+
+  Ring* create_ring(size_t out_cap);
+  void destroy_ring(Ring* ring);
+  Ring* grow(Ring* ring, std::ptrdiff_t start, std::ptrdiff_t end);
+
+  slot_alloc alloc_;
+  ring_alloc ring_alloc_;
+  std::vector<Ring*> retired_;
+  alignas(64) std::atomic<std::ptrdiff_t> start_ = 0;
+  alignas(64) std::atomic<std::ptrdiff_t> end_ = 0;
+  std::atomic<Ring*> ring_;
+};
+
+template <typename T, typename Allocator>
+struct WorkStealingDeque<T, Allocator>::Ring {
+  slot_type& operator[](std::ptrdiff_t index) {
+    size_t pos = static_cast<size_t>(index) & index_mask;
+    return arr[pos >> kIntShift][pos & kIntMask];
+  }
+
+  std::vector<slot_type*> arr;
+  size_t index_mask;
+};
+
+template <typename T, typename Allocator>
+WorkStealingDeque<T, Allocator>::WorkStealingDeque(size_t capacity,
+                                                   const Allocator& alloc)
+    : alloc_(alloc), ring_alloc_(alloc) {
+  size_t out_cap = 1;
+  while ((out_cap << kIntShift) < capacity) {
+    out_cap <<= 1;
+  }
+  ring_.store(create_ring(out_cap), std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+WorkStealingDeque<T, Allocator>::~WorkStealingDeque() {
+  destroy_ring(ring_.load(std::memory_order_relaxed));
+  for (Ring* ring : retired_) {
+    destroy_ring(ring);
+  }
+}
+
+template <typename T, typename Allocator>
+typename WorkStealingDeque<T, Allocator>::Ring*
+WorkStealingDeque<T, Allocator>::create_ring(size_t out_cap) {
+  Ring* ring = ring_alloc_traits::allocate(ring_alloc_, 1);
+  ring_alloc_traits::construct(ring_alloc_, ring);
+  ring->index_mask = (out_cap << kIntShift) - 1;
+  try {
+    ring->arr.reserve(out_cap);
+    for (size_t i = 0; i < out_cap; ++i) {
+      ring->arr.push_back(slot_alloc_traits::allocate(alloc_, kIntCap));
+      for (size_t j = 0; j < kIntCap; ++j) {
+        slot_alloc_traits::construct(alloc_, ring->arr.back() + j);
+      }
+    }
+  } catch (...) {
+    destroy_ring(ring);
+    throw;
+  }
+  return ring;
+}
+
+template <typename T, typename Allocator>
+void WorkStealingDeque<T, Allocator>::destroy_ring(Ring* ring) {
+  for (slot_type* block : ring->arr) {
+    slot_alloc_traits::deallocate(alloc_, block, kIntCap);
+  }
+  ring_alloc_traits::destroy(ring_alloc_, ring);
+  ring_alloc_traits::deallocate(ring_alloc_, ring, 1);
+}
+
+template <typename T, typename Allocator>
+typename WorkStealingDeque<T, Allocator>::Ring*
+WorkStealingDeque<T, Allocator>::grow(Ring* ring, std::ptrdiff_t start,
+                                      std::ptrdiff_t end) {
+  Ring* new_ring = create_ring(ring->arr.size() * 2);
+  for (std::ptrdiff_t i = start; i < end; ++i) {
+    (*new_ring)[i].store((*ring)[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+  }
+  retired_.push_back(ring);
+  ring_.store(new_ring, std::memory_order_release);
+  return new_ring;
+}
+
+template <typename T, typename Allocator>
+size_t WorkStealingDeque<T, Allocator>::size() const {
+  std::ptrdiff_t end = end_.load(std::memory_order_relaxed);
+  std::ptrdiff_t start = start_.load(std::memory_order_relaxed);
+  return end > start ? end - start : 0;
+}
+
+template <typename T, typename Allocator>
+bool WorkStealingDeque<T, Allocator>::empty() const {
+  return size() == 0;
+}
+
+template <typename T, typename Allocator>
+void WorkStealingDeque<T, Allocator>::push_back(const T& elem) {
+  std::ptrdiff_t end = end_.load(std::memory_order_relaxed);
+  std::ptrdiff_t start = start_.load(std::memory_order_acquire);
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  if (static_cast<size_t>(end - start) > ring->index_mask) {
+    ring = grow(ring, start, end);
+  }
+  (*ring)[end].store(elem, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  end_.store(end + 1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+bool WorkStealingDeque<T, Allocator>::pop_back(T& elem) {
+  std::ptrdiff_t end = end_.load(std::memory_order_relaxed) - 1;
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  end_.store(end, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::ptrdiff_t start = start_.load(std::memory_order_relaxed);
+  if (start > end) {
+    end_.store(end + 1, std::memory_order_relaxed);
+    return false;
+  }
+  elem = (*ring)[end].load(std::memory_order_relaxed);
+  if (start == end) {
+    bool won = start_.compare_exchange_strong(start, start + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+    end_.store(end + 1, std::memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+template <typename T, typename Allocator>
+bool WorkStealingDeque<T, Allocator>::steal_front(T& elem) {
+  std::ptrdiff_t start = start_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::ptrdiff_t end = end_.load(std::memory_order_acquire);
+  if (start >= end) {
+    return false;
+  }
+  Ring* ring = ring_.load(std::memory_order_acquire);
+  T value = (*ring)[start].load(std::memory_order_relaxed);
+  if (!start_.compare_exchange_strong(start, start + 1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+    return false;
+  }
+  elem = value;
+  return true;
+}
@@ -0,0 +1,176 @@
+// g++ -std=c++20 -O2 -DNDEBUG deque_bench.cpp && ./a.out [max_count]
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <string>
+
+#include "deque.hpp"
+
+namespace {
+
+size_t allocations = 0;
+volatile uint64_t sink = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+template <size_t kBytes>
+struct Blob {
+  Blob() = default;
+  Blob(uint64_t key) : key(key) {}
+
+  bool operator<(const Blob& other) const { return key < other.key; }
+
+  uint64_t key = 0;
+  std::array<char, kBytes - sizeof(uint64_t)> pad{};
+};
+
+template <typename Container>
+constexpr bool kHasFront =
+    requires(Container& container) { container.push_front({}); };
+
+class Timer {
+ public:
+  Timer(const char* container, const char* element, size_t count)
+      : container_(container), element_(element), count_(count) {}
+
+  template <typename Func>
+  void run(const char* op, size_t ops, Func func) {
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf("%-10s %-8s %-10s %10zu %10.2f %10.2f %10zu\n", container_,
+                element_, op, count_, ns / ops, ops * 1e3 / ns,
+                allocations - before);
+  }
+
+ private:
+  const char* container_;
+  const char* element_;
+  size_t count_;
+};
+
+template <typename Container>
+void Bench(const char* name, const char* element, size_t count) {
+  using T = typename Container::value_type;
+  const size_t kStride = 2654435761u;
+  Timer timer(name, element, count);
+  timer.run("construct", count, [&] {
+    Container container(count, T(1));
+    sink = sink + container[count / 2].key;
+  });
+  Container container;
+  timer.run("push_back", count, [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.push_back(T(i));
+    }
+  });
+  timer.run("index", count, [&] {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+      sum += container[i * kStride % count].key;
+    }
+    sink = sink + sum;
+  });
+  timer.run("traverse", count, [&] {
+    uint64_t sum = 0;
+    for (const T& elem : container) {
+      sum += elem.key;
+    }
+    sink = sink + sum;
+  });
+  std::mt19937_64 random(count);
+  for (size_t i = 0; i < count; ++i) {
+    container[i].key = random();
+  }
+  timer.run("sort", count,
+            [&] { std::sort(container.begin(), container.end()); });
+  size_t middle_ops = std::min<size_t>(count, 1000);
+  timer.run("insert", middle_ops, [&] {
+    for (size_t i = 0; i < middle_ops; ++i) {
+      container.insert(container.begin() + container.size() / 2, T(i));
+    }
+  });
+  timer.run("erase", middle_ops, [&] {
+    for (size_t i = 0; i < middle_ops; ++i) {
+      container.erase(container.begin() + container.size() / 2);
+    }
+  });
+  timer.run("pop_back", count, [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.pop_back();
+      sink = sink + container.size();
+    }
+  });
+  if constexpr (kHasFront<Container>) {
+    timer.run("push_front", count, [&] {
+      for (size_t i = 0; i < count; ++i) {
+        container.push_front(T(i));
+      }
+    });
+    timer.run("pop_front", count, [&] {
+      for (size_t i = 0; i < count; ++i) {
+        container.pop_front();
+        sink = sink + container.size();
+      }
+    });
+  }
+}
+
+// Each case runs in its own process so the reported peak RSS belongs to it.
+template <typename Func>
+void Isolated(Func func) {
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    func();
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%-10s peak rss %ld KiB\n", "", usage.ru_maxrss);
+    std::fflush(stdout);
+    std::_Exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+}
+
+template <typename T>
+void BenchElement(const char* element, size_t max_count) {
+  for (size_t count = 10; count <= max_count; count *= 10) {
+    Isolated([&] { Bench<Deque<T>>("Deque", element, count); });
+    Isolated([&] { Bench<std::deque<T>>("std_deque", element, count); });
+    Isolated([&] { Bench<std::vector<T>>("std_vector", element, count); });
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t max_count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+  std::printf("%-10s %-8s %-10s %10s %10s %10s %10s\n", "container",
+              "element", "op", "count", "ns/op", "Mops/s", "allocs");
+  BenchElement<Blob<8>>("8B", max_count);
+  BenchElement<Blob<64>>("64B", max_count);
+  BenchElement<Blob<256>>("256B", max_count);
+}
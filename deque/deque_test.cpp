@@ -0,0 +1,335 @@
+// g++ -std=c++20 -O2 deque_test.cpp && ./a.out
+#include <cassert>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+
+namespace {
+
+size_t allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+void TestFifoKeepsTableBounded() {
+  const size_t kLive = 100;
+  const size_t kWarmup = 64 * kIntCap;
+  const size_t kOperations = 1024 * kIntCap;
+  Deque<int> deque;
+  int next = 0;
+  for (size_t i = 0; i < kLive; ++i) {
+    deque.push_back(next++);
+  }
+  for (size_t i = 0; i < kWarmup; ++i) {
+    deque.push_back(next++);
+    deque.pop_front();
+  }
+  int expected = next - static_cast<int>(kLive);
+  size_t before = allocations;
+  for (size_t i = 0; i < kOperations; ++i) {
+    deque.push_back(next++);
+    assert(deque[0] == expected);
+    deque.pop_front();
+    ++expected;
+  }
+  assert(allocations == before);
+  assert(deque.size() == kLive);
+}
+
+void TestFifoFromFront() {
+  Deque<int> deque;
+  for (int i = 0; i < 10; ++i) {
+    deque.push_front(i);
+  }
+  for (size_t i = 0; i < 256 * kIntCap; ++i) {
+    deque.push_front(deque[0] + 1);
+    deque.pop_back();
+  }
+  size_t before = allocations;
+  for (size_t i = 0; i < 256 * kIntCap; ++i) {
+    deque.push_front(deque[0] + 1);
+    deque.pop_back();
+  }
+  assert(allocations == before);
+  for (size_t i = 1; i < deque.size(); ++i) {
+    assert(deque[i - 1] == deque[i] + 1);
+  }
+}
+
+// Returns a deque holding -front..back-1 whose first element sits in the
+// middle of a block, so fixed offsets land on both sides of block edges.
+Deque<int> MakeUnaligned(int front, int back, std::vector<int>& expected) {
+  Deque<int> deque;
+  for (int i = 0; i < back; ++i) {
+    deque.push_back(i);
+  }
+  for (int i = 1; i <= front; ++i) {
+    deque.push_front(-i);
+  }
+  expected.clear();
+  for (int i = -front; i < back; ++i) {
+    expected.push_back(i);
+  }
+  return deque;
+}
+
+void TestIteratorArithmeticAcrossBlocks() {
+  std::vector<int> expected;
+  Deque<int> deque =
+      MakeUnaligned(100, 3 * static_cast<int>(kIntCap) + 17, expected);
+  assert(deque.size() == expected.size());
+  assert(static_cast<size_t>(deque.end() - deque.begin()) == expected.size());
+  const std::ptrdiff_t kSize = deque.end() - deque.begin();
+  const std::ptrdiff_t kSteps[] = {
+      1, 2, kIntCap - 1, kIntCap, kIntCap + 1, 2 * kIntCap + 3};
+  for (std::ptrdiff_t step : kSteps) {
+    for (std::ptrdiff_t i = 0; i + step < kSize; i += 97) {
+      auto it = deque.begin() + i;
+      auto next = it + step;
+      assert(*it == expected[i]);
+      assert(*next == expected[i + step]);
+      assert(it[step] == expected[i + step]);
+      assert(next - it == step && it - next == -step);
+      assert(it < next && next > it && it <= next && next >= it);
+      assert(it != next && !(it == next) && it <= it && it >= it);
+      assert(next - step == it && step + it == next);
+      auto back = next;
+      back -= step;
+      assert(back == it && *back == expected[i]);
+      Deque<int>::const_iterator const_it = it;
+      assert(*const_it == expected[i] && const_it + step == next);
+    }
+  }
+  size_t index = 0;
+  for (auto it = deque.begin(); it != deque.end(); ++it) {
+    assert(*it == expected[index++]);
+  }
+  for (auto it = deque.end(); it != deque.begin();) {
+    assert(*--it == expected[--index]);
+  }
+  auto rev = std::vector<int>(deque.rbegin(), deque.rend());
+  assert(std::equal(rev.begin(), rev.end(), expected.rbegin()));
+}
+
+void TestSortAndSearchMatchVector() {
+  std::vector<int> expected;
+  Deque<int> deque =
+      MakeUnaligned(1000, 2 * static_cast<int>(kIntCap) + 5, expected);
+  std::mt19937 random(7);
+  for (size_t i = 0; i < deque.size(); ++i) {
+    deque[i] = expected[i] = static_cast<int>(random() % 5000);
+  }
+  std::sort(deque.begin(), deque.end());
+  std::sort(expected.begin(), expected.end());
+  assert(std::equal(deque.begin(), deque.end(), expected.begin(),
+                    expected.end()));
+  for (int key = -10; key < 5010; key += 7) {
+    auto found = std::lower_bound(deque.begin(), deque.end(), key);
+    auto reference = std::lower_bound(expected.begin(), expected.end(), key);
+    assert(found - deque.begin() == reference - expected.begin());
+  }
+}
+
+void TestSegmentedMatchesStd() {
+  std::vector<int> expected;
+  Deque<int> deque =
+      MakeUnaligned(300, 3 * static_cast<int>(kIntCap) + 41, expected);
+  static_assert(Segmented::kIsSegmented<Deque<int>::iterator>);
+  static_assert(!Segmented::kIsSegmented<std::vector<int>::iterator>);
+  const size_t kSize = deque.size();
+  const size_t kBounds[][2] = {{0, kSize},
+                               {0, 0},
+                               {5, 6},
+                               {1, kIntCap + 2},
+                               {kIntCap - 3, 2 * kIntCap + 7},
+                               {kSize - kIntCap - 1, kSize}};
+  for (const auto& bounds : kBounds) {
+    auto first = deque.begin() + bounds[0];
+    auto last = deque.begin() + bounds[1];
+    auto ref_first = expected.begin() + bounds[0];
+    auto ref_last = expected.begin() + bounds[1];
+    long long sum = Segmented::accumulate(first, last, 0LL);
+    assert(sum == std::accumulate(ref_first, ref_last, 0LL));
+    long long visited = 0;
+    Segmented::for_each(first, last, [&visited](int value) {
+      visited += value;
+    });
+    assert(visited == sum);
+    std::vector<int> copied(bounds[1] - bounds[0]);
+    assert(Segmented::copy(first, last, copied.begin()) == copied.end());
+    assert(std::equal(copied.begin(), copied.end(), ref_first, ref_last));
+    std::ptrdiff_t length = last - first;
+    for (std::ptrdiff_t offset : {std::ptrdiff_t(0), length / 2, length - 1}) {
+      if (offset < 0 || offset >= length) {
+        continue;
+      }
+      int value = ref_first[offset];
+      auto found = Segmented::find(first, last, value);
+      assert(found - first == offset && *found == value);
+    }
+    assert(Segmented::find(first, last, -100000) == last);
+  }
+  std::vector<int> source(2 * kIntCap + 9);
+  std::iota(source.begin(), source.end(), 1000000);
+  auto out = deque.begin() + 50;
+  assert(Segmented::copy(source.begin(), source.end(), out) ==
+         out + source.size());
+  std::copy(source.begin(), source.end(), expected.begin() + 50);
+  Segmented::fill(deque.begin() + kIntCap - 1, deque.begin() + 2 * kIntCap + 1,
+                  -7);
+  std::fill(expected.begin() + kIntCap - 1, expected.begin() + 2 * kIntCap + 1,
+            -7);
+  assert(std::equal(deque.begin(), deque.end(), expected.begin(),
+                    expected.end()));
+  assert(Segmented::accumulate(expected.begin(), expected.end(), 0LL) ==
+         Segmented::accumulate(deque.begin(), deque.end(), 0LL));
+}
+
+template <typename T, bool kPropagate>
+struct TaggedAllocator {
+  using value_type = T;
+  using propagate_on_container_move_assignment =
+      std::bool_constant<kPropagate>;
+
+  template <typename U>
+  struct rebind {
+    using other = TaggedAllocator<U, kPropagate>;
+  };
+
+  explicit TaggedAllocator(int id) : id(id) {}
+
+  template <typename U>
+  TaggedAllocator(const TaggedAllocator<U, kPropagate>& other)
+      : id(other.id) {}
+
+  T* allocate(size_t count) { return std::allocator<T>().allocate(count); }
+
+  void deallocate(T* ptr, size_t count) {
+    std::allocator<T>().deallocate(ptr, count);
+  }
+
+  bool operator==(const TaggedAllocator& other) const {
+    return id == other.id;
+  }
+
+  int id;
+};
+
+void TestLazyConstructionAndMoves() {
+  size_t before = allocations;
+  Deque<int> lazy;
+  Deque<int> lazy_alloc{std::allocator<int>()};
+  assert(allocations == before);
+  assert(lazy.empty() && lazy.begin() == lazy.end());
+  assert(lazy_alloc.size() == 0 && lazy_alloc.end() - lazy_alloc.begin() == 0);
+  Deque<int> moved_empty(std::move(lazy));
+  assert(allocations == before && moved_empty.empty());
+
+  static_assert(std::is_nothrow_move_constructible_v<Deque<int>>);
+  static_assert(std::is_nothrow_move_assignable_v<Deque<int>>);
+  static_assert(std::is_nothrow_swappable_v<Deque<int>>);
+  static_assert(noexcept(std::declval<Deque<int>&>().swap(
+      std::declval<Deque<int>&>())));
+  static_assert(!std::is_nothrow_move_assignable_v<
+                Deque<int, TaggedAllocator<int, false>>>);
+
+  Deque<int> source;
+  for (int i = 0; i < 3 * static_cast<int>(kIntCap); ++i) {
+    source.push_back(i);
+  }
+  const int* first = &source[0];
+  before = allocations;
+  Deque<int> moved(std::move(source));
+  assert(allocations == before && &moved[0] == first);
+  assert(source.empty() && source.begin() == source.end());
+  source.push_back(7);
+  assert(source.size() == 1 && source[0] == 7);
+  Deque<int> assigned;
+  before = allocations;
+  assigned = std::move(moved);
+  assert(allocations == before && &assigned[0] == first);
+  assigned.swap(source);
+  assert(source.size() == 3 * kIntCap && &source[0] == first);
+  assert(assigned.size() == 1 && assigned[0] == 7);
+
+  std::vector<Deque<int>> deques(4);
+  deques[0].push_back(1);
+  const int* held = &deques[0][0];
+  before = allocations;
+  deques.reserve(64);
+  assert(allocations == before + 1 && &deques[0][0] == held);
+}
+
+template <bool kPropagate>
+void TestMoveAssignWithUnequalAllocators() {
+  using Alloc = TaggedAllocator<int, kPropagate>;
+  Deque<int, Alloc> lhs{Alloc(1)};
+  Deque<int, Alloc> rhs{Alloc(2)};
+  lhs.push_back(-1);
+  for (int i = 0; i < 100; ++i) {
+    rhs.push_back(i);
+  }
+  const int* first = &rhs[0];
+  lhs = std::move(rhs);
+  assert(lhs.size() == 100 && lhs[0] == 0 && lhs[99] == 99);
+  assert(rhs.empty());
+  if constexpr (kPropagate) {
+    assert(lhs.get_allocator().id == 2 && &lhs[0] == first);
+  } else {
+    assert(lhs.get_allocator().id == 1 && &lhs[0] != first);
+  }
+  Deque<int, Alloc> same(std::move(lhs), Alloc(lhs.get_allocator().id));
+  assert(same.size() == 100 && lhs.empty());
+  Deque<int, Alloc> other(std::move(same), Alloc(3));
+  assert(other.get_allocator().id == 3 && other.size() == 100);
+  assert(other[42] == 42 && same.empty());
+}
+
+void TestEmplaceAtPosition() {
+  Deque<std::pair<int, int>> deque;
+  std::deque<std::pair<int, int>> expected;
+  std::mt19937 random(3);
+  for (int i = 0; i < 3 * static_cast<int>(kIntCap); ++i) {
+    size_t index = random() % (deque.size() + 1);
+    deque.emplace(deque.begin() + index, i, -i);
+    expected.emplace(expected.begin() + index, i, -i);
+  }
+  assert(std::equal(deque.begin(), deque.end(), expected.begin(),
+                    expected.end()));
+  for (int i = 0; i < static_cast<int>(kIntCap); ++i) {
+    size_t index = random() % deque.size();
+    deque.erase(deque.begin() + index);
+    expected.erase(expected.begin() + index);
+  }
+  assert(std::equal(deque.begin(), deque.end(), expected.begin(),
+                    expected.end()));
+}
+
+int main() {
+  TestLazyConstructionAndMoves();
+  TestMoveAssignWithUnequalAllocators<false>();
+  TestMoveAssignWithUnequalAllocators<true>();
+  TestEmplaceAtPosition();
+  TestIteratorArithmeticAcrossBlocks();
+  TestSortAndSearchMatchVector();
+  TestSegmentedMatchesStd();
+  TestFifoKeepsTableBounded();
+  TestFifoFromFront();
+  std::cout << "OK\n";
+}
@@ -0,0 +1,148 @@
+// g++ -std=c++20 -O1 -g -fsanitize=thread concurrent_list_stress.cpp -pthread
+// g++ -std=c++20 -O2 -DNDEBUG concurrent_list_stress.cpp -pthread &&
+//     ./a.out bench
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "list.hpp"
+
+void StressPushAndTakeAll(size_t producers, size_t count) {
+  ConcurrentList<size_t> list;
+  std::atomic<size_t> running = producers;
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < count; ++i) {
+        size_t value = p * count + i;
+        if (i % 2 == 0) {
+          list.push_back(value);
+        } else {
+          list.emplace_front(value);
+        }
+      }
+      running.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  std::vector<unsigned char> seen(producers * count, 0);
+  std::vector<size_t> last_back(producers, 0);
+  std::vector<bool> any_back(producers, false);
+  size_t taken = 0;
+  auto drain = [&] {
+    List<size_t> batch = list.take_all();
+    std::vector<size_t> last_front(producers, 0);
+    std::vector<bool> any_front(producers, false);
+    for (size_t value : batch) {
+      assert(value < seen.size());
+      assert(seen[value] == 0);
+      seen[value] = 1;
+      size_t p = value / count;
+      if (value % count % 2 == 0) {
+        assert(!any_back[p] || last_back[p] < value);
+        last_back[p] = value;
+        any_back[p] = true;
+      } else {
+        assert(!any_front[p] || last_front[p] > value);
+        last_front[p] = value;
+        any_front[p] = true;
+      }
+    }
+    taken += batch.size();
+  };
+  while (running.load(std::memory_order_acquire) != 0) {
+    drain();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  drain();
+  assert(taken == producers * count);
+  assert(list.empty());
+}
+
+class LockedList {
+ public:
+  void push_back(size_t value) {
+    std::lock_guard lock(mutex_);
+    list_.push_back(value);
+  }
+
+  void emplace_front(size_t value) {
+    std::lock_guard lock(mutex_);
+    list_.emplace_front(value);
+  }
+
+  List<size_t> take_all() {
+    std::lock_guard lock(mutex_);
+    return std::move(list_);
+  }
+
+ private:
+  std::mutex mutex_;
+  List<size_t> list_;
+};
+
+// Same producer/consumer pattern as StressPushAndTakeAll, without the
+// ordering checks, so the time is spent in the list itself.
+template <typename Queue>
+double BenchPushAndTakeAll(size_t producers, size_t count) {
+  Queue queue;
+  std::atomic<size_t> running = producers;
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < count; ++i) {
+        if (i % 2 == 0) {
+          queue.push_back(p * count + i);
+        } else {
+          queue.emplace_front(p * count + i);
+        }
+      }
+      running.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  size_t taken = 0;
+  while (running.load(std::memory_order_acquire) != 0) {
+    taken += queue.take_all().size();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  taken += queue.take_all().size();
+  auto stop = std::chrono::steady_clock::now();
+  if (taken != producers * count) {
+    std::cerr << "lost elements\n";
+    std::abort();
+  }
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+void Bench() {
+  const size_t kCount = 1 << 20;
+  std::printf("%-10s %22s %18s\n", "producers", "ConcurrentList Mops/s",
+              "mutex List Mops/s");
+  for (size_t producers : {1, 2, 4, 8}) {
+    size_t per_producer = kCount / producers;
+    double lock_free = BenchPushAndTakeAll<ConcurrentList<size_t>>(
+        producers, per_producer);
+    double locked = BenchPushAndTakeAll<LockedList>(producers, per_producer);
+    std::printf("%-10zu %22.2f %18.2f\n", producers,
+                kCount / lock_free * 1e-6, kCount / locked * 1e-6);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+    Bench();
+    return 0;
+  }
+  for (int round = 0; round < 8; ++round) {
+    StressPushAndTakeAll(4, 1 << 16);
+  }
+  std::cout << "OK\n";
+}
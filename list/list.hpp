@@ -1,8 +1,182 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+template <size_t kSlabSize>
+class PoolResource {
+ public:
+  class Pool;
+
+  Pool* get_pool(size_t slot_size);
+
+ private:
+  std::vector<std::unique_ptr<Pool>> pools_;
+};
+
+template <size_t kSlabSize>
+class PoolResource<kSlabSize>::Pool {
+ public:
+  explicit Pool(size_t slot_size) : slot_size_(slot_size) {}
+  Pool(const Pool& other) = delete;
+  Pool& operator=(const Pool& other) = delete;
+  ~Pool();
+
+  size_t slot_size() const { return slot_size_; }
+
+  void* allocate();
+  void deallocate(void* ptr);
+
+ private:
+  size_t slot_size_;
+  void* free_list_ = nullptr;
+  char* cursor_ = nullptr;
+  char* slab_end_ = nullptr;
+  std::vector<void*> slabs_;
+};
+
+template <size_t kSlabSize>
+typename PoolResource<kSlabSize>::Pool* PoolResource<kSlabSize>::get_pool(
+    size_t slot_size) {
+  for (auto& pool : pools_) {
+    if (pool->slot_size() == slot_size) {
+      return pool.get();
+    }
+  }
+  pools_.push_back(std::make_unique<Pool>(slot_size));
+  return pools_.back().get();
+}
+
+template <size_t kSlabSize>
+PoolResource<kSlabSize>::Pool::~Pool() {
+  for (void* slab : slabs_) {
+    ::operator delete(slab, slot_size_ * kSlabSize);
+  }
+}
+
+template <size_t kSlabSize>
+void* PoolResource<kSlabSize>::Pool::allocate() {
+  void* slot = free_list_;
+  if (slot != nullptr) {
+    free_list_ = *static_cast<void**>(slot);
+    return slot;
+  }
+  if (cursor_ == slab_end_) {
+    char* slab = static_cast<char*>(::operator new(slot_size_ * kSlabSize));
+    try {
+      slabs_.push_back(slab);
+    } catch (...) {
+      ::operator delete(slab, slot_size_ * kSlabSize);
+      throw;
+    }
+    cursor_ = slab;
+    slab_end_ = slab + slot_size_ * kSlabSize;
+  }
+  slot = cursor_;
+  cursor_ += slot_size_;
+  return slot;
+}
+
+template <size_t kSlabSize>
+void PoolResource<kSlabSize>::Pool::deallocate(void* ptr) {
+  *static_cast<void**>(ptr) = free_list_;
+  free_list_ = ptr;
+}
+
+template <typename T, size_t kSlabSize = 4096>
+class PoolAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = PoolAllocator<U, kSlabSize>;
+  };
+
+  PoolAllocator();
+  PoolAllocator(const PoolAllocator& other) = default;
+  PoolAllocator& operator=(const PoolAllocator& other) = default;
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U, kSlabSize>& other);
+
+  T* allocate(size_t count);
+  void deallocate(T* ptr, size_t count);
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U, kSlabSize>& other) const;
+  template <typename U>
+  bool operator!=(const PoolAllocator<U, kSlabSize>& other) const;
+
+ private:
+  template <typename U, size_t kOtherSlabSize>
+  friend class PoolAllocator;
+
+  using Pool = typename PoolResource<kSlabSize>::Pool;
+
+  static constexpr size_t kSlotAlign = std::max(alignof(T), alignof(void*));
+  static constexpr size_t kSlotSize =
+      (std::max(sizeof(T), sizeof(void*)) + kSlotAlign - 1) / kSlotAlign *
+      kSlotAlign;
+  static constexpr bool kPooled = alignof(T) <= alignof(std::max_align_t);
+
+  std::shared_ptr<PoolResource<kSlabSize>> resource_;
+  Pool* pool_;
+};
+
+template <typename T, size_t kSlabSize>
+PoolAllocator<T, kSlabSize>::PoolAllocator()
+    : resource_(std::make_shared<PoolResource<kSlabSize>>()),
+      pool_(resource_->get_pool(kSlotSize)) {}
+
+template <typename T, size_t kSlabSize>
+template <typename U>
+PoolAllocator<T, kSlabSize>::PoolAllocator(
+    const PoolAllocator<U, kSlabSize>& other)
+    : resource_(other.resource_), pool_(resource_->get_pool(kSlotSize)) {}
+
+template <typename T, size_t kSlabSize>
+T* PoolAllocator<T, kSlabSize>::allocate(size_t count) {
+  if (count != 1 || !kPooled) {
+    return std::allocator<T>().allocate(count);
+  }
+  return static_cast<T*>(pool_->allocate());
+}
+
+template <typename T, size_t kSlabSize>
+void PoolAllocator<T, kSlabSize>::deallocate(T* ptr, size_t count) {
+  if (count != 1 || !kPooled) {
+    std::allocator<T>().deallocate(ptr, count);
+    return;
+  }
+  pool_->deallocate(ptr);
+}
+
+template <typename T, size_t kSlabSize>
+template <typename U>
+bool PoolAllocator<T, kSlabSize>::operator==(
+    const PoolAllocator<U, kSlabSize>& other) const {
+  return resource_ == other.resource_;
+}
+
+template <typename T, size_t kSlabSize>
+template <typename U>
+bool PoolAllocator<T, kSlabSize>::operator!=(
+    const PoolAllocator<U, kSlabSize>& other) const {
+  return resource_ != other.resource_;
+}
 
 template <typename T, typename Allocator = std::allocator<T>>
 class List {
  private:
+  struct BaseNode;
   struct Node;
 
  public:
@@ -24,6 +198,9 @@ class List {
   friend class CommonIterator<false>;
   friend class CommonIterator<true>;
 
+  template <typename U, typename OtherAllocator>
+  friend class ConcurrentList;
+
   iterator begin();
   iterator end();
   const_iterator begin() const;
@@ -39,11 +216,16 @@ class List {
   void add_node_front(Node* ptr);
 
   List();
+  explicit List(const Allocator& alloc);
   List(size_t count, const T& value, const Allocator& alloc = Allocator());
   explicit List(size_t count, const Allocator& alloc = Allocator());
   List(const List& other);
+  List(List&& other) noexcept;
   List(std::initializer_list<T> init, const Allocator& alloc = Allocator());
   List& operator=(const List& other);
+  List& operator=(List&& other) noexcept(
+      node_alloc_traits::propagate_on_container_move_assignment::value ||
+      node_alloc_traits::is_always_equal::value);
   ~List();
 
   template <typename U>
@@ -64,23 +246,86 @@ class List {
   void push_front(T&& value);
   void pop_front();
 
+  template <typename... Args>
+  T& emplace_back(Args&&... args);
+  template <typename... Args>
+  T& emplace_front(Args&&... args);
+
+  iterator insert(const_iterator pos, const T& value);
+  iterator insert(const_iterator pos, T&& value);
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+
+  void splice(const_iterator pos, List& other);
+  void splice(const_iterator pos, List&& other);
+  void splice(const_iterator pos, List& other, const_iterator iter);
+  void splice(const_iterator pos, List&& other, const_iterator iter);
+  void splice(const_iterator pos, List& other, const_iterator first,
+              const_iterator last);
+  void splice(const_iterator pos, List&& other, const_iterator first,
+              const_iterator last);
+
+  void sort();
+  template <typename Compare>
+  void sort(Compare comp);
+
+  void merge(List& other);
+  void merge(List&& other);
+  template <typename Compare>
+  void merge(List& other, Compare comp);
+  template <typename Compare>
+  void merge(List&& other, Compare comp);
+
+  size_t unique();
+  template <typename BinaryPredicate>
+  size_t unique(BinaryPredicate pred);
+
+  size_t remove(const T& value);
+  template <typename UnaryPredicate>
+  size_t remove_if(UnaryPredicate pred);
+
+  void reverse() noexcept;
+
   void clear() noexcept;
   node_alloc& get_allocator();
 
  private:
+  template <typename Compare>
+  static void merge_chains(BaseNode*& first, BaseNode* second, Compare& comp);
+  static T& value_of(BaseNode* ptr);
+  void relink_chain(BaseNode* chain) noexcept;
+
+  template <typename... Args>
+  Node* create_node(Args&&... args);
+  void destroy_node(BaseNode* ptr) noexcept;
+
+  template <typename InputIt>
+  void assign_range(InputIt first, InputIt last);
+  void steal(List& other) noexcept;
+
+  static void link_before(BaseNode* pos, BaseNode* first, BaseNode* last);
+  static void unlink(BaseNode* first, BaseNode* last);
+  void reset_fake() noexcept;
+
   size_t size_ = 0;
-  Node* head_ = nullptr;
-  Node* tail_ = nullptr;
+  BaseNode fake_;
   node_alloc alloc_;
 };
 
 template <typename T, typename Allocator>
-struct List<T, Allocator>::Node {
-  Node() = default;
-  Node(Node* left_ptr, Node* right_ptr, const T& val)
-      : left(left_ptr), right(right_ptr), value(val) {}
-  Node* left = nullptr;
-  Node* right = nullptr;
+struct List<T, Allocator>::BaseNode {
+  BaseNode* left = this;
+  BaseNode* right = this;
+};
+
+template <typename T, typename Allocator>
+struct List<T, Allocator>::Node : BaseNode {
+  template <typename... Args>
+  explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
   T value;
 };
 
@@ -94,13 +339,13 @@ class List<T, Allocator>::CommonIterator {
   using reference = std::conditional_t<IsConst, const T, T>&;
   using difference_type = std::ptrdiff_t;
 
-  CommonIterator(std::conditional_t<IsConst, const List, List>* list,
-                 Node* node)
-      : list_(list), node_(node) {}
+  explicit CommonIterator(BaseNode* node) : node_(node) {}
 
-  reference operator*() const { return node_->value; }
+  operator CommonIterator<true>() const { return CommonIterator<true>(node_); }
 
-  pointer operator->() const { return &node_->value; }
+  reference operator*() const { return static_cast<Node*>(node_)->value; }
+
+  pointer operator->() const { return &static_cast<Node*>(node_)->value; }
 
   CommonIterator& operator++() {
     node_ = node_->right;
@@ -114,11 +359,7 @@ class List<T, Allocator>::CommonIterator {
   }
 
   CommonIterator& operator--() {
-    if (node_ != nullptr) {
-      node_ = node_->left;
-    } else {
-      node_ = list_->tail_;
-    }
+    node_ = node_->left;
     return *this;
   }
 
@@ -137,30 +378,93 @@ class List<T, Allocator>::CommonIterator {
   }
 
  private:
-  std::conditional_t<IsConst, const List, List>* list_;
-  Node* node_;
+  friend List;
+
+  BaseNode* node_;
 };
 
 template <typename T, typename Allocator>
-void List<T, Allocator>::add_node_back(Node* ptr) {
-  if (tail_ != nullptr) {
-    tail_->right = ptr;
-    ptr->left = tail_;
-  } else {
-    head_ = ptr;
+void List<T, Allocator>::link_before(BaseNode* pos, BaseNode* first,
+                                     BaseNode* last) {
+  first->left = pos->left;
+  last->right = pos;
+  pos->left->right = first;
+  pos->left = last;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::unlink(BaseNode* first, BaseNode* last) {
+  first->left->right = last->right;
+  last->right->left = first->left;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::reset_fake() noexcept {
+  fake_.left = &fake_;
+  fake_.right = &fake_;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+typename List<T, Allocator>::Node* List<T, Allocator>::create_node(
+    Args&&... args) {
+  Node* ptr = node_alloc_traits::allocate(alloc_, 1);
+  try {
+    node_alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+  } catch (...) {
+    node_alloc_traits::deallocate(alloc_, ptr, 1);
+    throw;
+  }
+  return ptr;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::destroy_node(BaseNode* ptr) noexcept {
+  Node* node = static_cast<Node*>(ptr);
+  node_alloc_traits::destroy(alloc_, node);
+  node_alloc_traits::deallocate(alloc_, node, 1);
+}
+
+template <typename T, typename Allocator>
+template <typename InputIt>
+void List<T, Allocator>::assign_range(InputIt first, InputIt last) {
+  BaseNode* curr = fake_.right;
+  for (; curr != &fake_ && first != last; ++first) {
+    value_of(curr) = *first;
+    curr = curr->right;
+  }
+  if (first == last) {
+    erase(const_iterator(curr), cend());
+    return;
+  }
+  for (; first != last; ++first) {
+    emplace_back(*first);
+  }
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::steal(List& other) noexcept {
+  if (other.size_ == 0) {
+    return;
   }
-  tail_ = ptr;
+  fake_.left = other.fake_.left;
+  fake_.right = other.fake_.right;
+  fake_.left->right = &fake_;
+  fake_.right->left = &fake_;
+  size_ = other.size_;
+  other.reset_fake();
+  other.size_ = 0;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::add_node_back(Node* ptr) {
+  link_before(&fake_, ptr, ptr);
   ++size_;
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::add_node_front(Node* ptr) {
-  if (head_ != nullptr) {
-    head_->left = ptr;
-  } else {
-    tail_ = ptr;
-  }
-  head_ = ptr;
+  link_before(fake_.right, ptr, ptr);
   ++size_;
 }
 
@@ -169,20 +473,19 @@ List<T, Allocator>::List() {
   alloc_ = Allocator();
 }
 
+template <typename T, typename Allocator>
+List<T, Allocator>::List(const Allocator& alloc) {
+  alloc_ = alloc;
+}
+
 template <typename T, typename Allocator>
 List<T, Allocator>::List(size_t count, const T& value, const Allocator& alloc) {
   alloc_ = alloc;
-  Node* ptr = nullptr;
   try {
     for (size_t i = 0; i < count; ++i) {
-      ptr = node_alloc_traits::allocate(alloc_, 1);
-      node_alloc_traits::construct(alloc_, ptr, tail_, nullptr, value);
-      add_node_back(ptr);
+      add_node_back(create_node(value));
     }
   } catch (...) {
-    if (ptr != nullptr) {
-      node_alloc_traits::deallocate(alloc_, ptr, 1);
-    }
     clear();
     throw;
   }
@@ -191,17 +494,11 @@ List<T, Allocator>::List(size_t count, const T& value, const Allocator& alloc) {
 template <typename T, typename Allocator>
 List<T, Allocator>::List(size_t count, const Allocator& alloc) {
   alloc_ = alloc;
-  Node* ptr = nullptr;
   try {
     for (size_t i = 0; i < count; ++i) {
-      ptr = node_alloc_traits::allocate(alloc_, 1);
-      node_alloc_traits::construct(alloc_, ptr);
-      add_node_back(ptr);
+      add_node_back(create_node());
     }
   } catch (...) {
-    if (ptr != nullptr) {
-      node_alloc_traits::deallocate(alloc_, ptr, 1);
-    }
     clear();
     throw;
   }
@@ -211,39 +508,30 @@ template <typename T, typename Allocator>
 List<T, Allocator>::List(const List& other) {
   alloc_ =
       node_alloc_traits::select_on_container_copy_construction(other.alloc_);
-  Node* curr = other.head_;
-  Node* ptr = nullptr;
   try {
-    while (size_ != other.size_) {
-      ptr = node_alloc_traits::allocate(alloc_, 1);
-      node_alloc_traits::construct(alloc_, ptr, tail_, nullptr, curr->value);
-      curr = curr->right;
-      add_node_back(ptr);
+    for (const auto& elem : other) {
+      add_node_back(create_node(elem));
     }
   } catch (...) {
-    if (ptr != nullptr) {
-      node_alloc_traits::deallocate(alloc_, ptr, 1);
-    }
     clear();
     throw;
   }
 }
 
+template <typename T, typename Allocator>
+List<T, Allocator>::List(List&& other) noexcept : alloc_(other.alloc_) {
+  steal(other);
+}
+
 template <typename T, typename Allocator>
 List<T, Allocator>::List(std::initializer_list<T> init,
                          const Allocator& alloc) {
   alloc_ = alloc;
-  Node* ptr = nullptr;
   try {
     for (const auto& elem : init) {
-      ptr = node_alloc_traits::allocate(alloc_, 1);
-      node_alloc_traits::construct(alloc_, ptr, tail_, nullptr, elem);
-      add_node_back(ptr);
+      add_node_back(create_node(elem));
     }
   } catch (...) {
-    if (ptr != nullptr) {
-      node_alloc_traits::deallocate(alloc_, ptr, 1);
-    }
     clear();
     throw;
   }
@@ -254,11 +542,38 @@ List<T, Allocator>& List<T, Allocator>::operator=(const List& other) {
   if (this == &other) {
     return *this;
   }
-  List copy(other);
-  if (alloc_traits::propagate_on_container_copy_assignment::value) {
+  if constexpr (node_alloc_traits::propagate_on_container_copy_assignment::
+                    value) {
+    if (alloc_ != other.alloc_) {
+      clear();
+    }
     alloc_ = other.alloc_;
   }
-  swap(copy);
+  assign_range(other.begin(), other.end());
+  return *this;
+}
+
+template <typename T, typename Allocator>
+List<T, Allocator>& List<T, Allocator>::operator=(List&& other) noexcept(
+    node_alloc_traits::propagate_on_container_move_assignment::value ||
+    node_alloc_traits::is_always_equal::value) {
+  if (this == &other) {
+    return *this;
+  }
+  if constexpr (node_alloc_traits::propagate_on_container_move_assignment::
+                    value) {
+    clear();
+    alloc_ = other.alloc_;
+    steal(other);
+  } else {
+    if (alloc_ == other.alloc_) {
+      clear();
+      steal(other);
+    } else {
+      assign_range(std::make_move_iterator(other.begin()),
+                   std::make_move_iterator(other.end()));
+    }
+  }
   return *this;
 }
 
@@ -270,45 +585,51 @@ List<T, Allocator>::~List() {
 template <typename T, typename Allocator>
 template <typename U>
 void List<T, Allocator>::swap(U& arg) {
-  Node* head_tmp = head_;
-  Node* tail_tmp = tail_;
-  size_t size_tmp = size_;
-  head_ = arg.head_;
-  tail_ = arg.tail_;
-  size_ = arg.size_;
-  arg.head_ = head_tmp;
-  arg.tail_ = tail_tmp;
-  arg.size_ = size_tmp;
+  std::swap(fake_, arg.fake_);
+  std::swap(size_, arg.size_);
+  std::swap(alloc_, arg.alloc_);
+  if (size_ == 0) {
+    reset_fake();
+  } else {
+    fake_.left->right = &fake_;
+    fake_.right->left = &fake_;
+  }
+  if (arg.size_ == 0) {
+    arg.reset_fake();
+  } else {
+    arg.fake_.left->right = &arg.fake_;
+    arg.fake_.right->left = &arg.fake_;
+  }
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::iterator List<T, Allocator>::begin() {
-  return iterator(this, head_);
+  return iterator(fake_.right);
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::iterator List<T, Allocator>::end() {
-  return iterator(this, tail_->right);
+  return iterator(&fake_);
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::const_iterator List<T, Allocator>::begin() const {
-  return const_iterator(this, head_);
+  return const_iterator(fake_.right);
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::const_iterator List<T, Allocator>::end() const {
-  return const_iterator(this, tail_->right);
+  return const_iterator(const_cast<BaseNode*>(&fake_));
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::const_iterator List<T, Allocator>::cbegin() const {
-  return const_iterator(this, head_);
+  return begin();
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::const_iterator List<T, Allocator>::cend() const {
-  return const_iterator(this, tail_->right);
+  return end();
 }
 
 template <typename T, typename Allocator>
@@ -345,91 +666,1509 @@ bool List<T, Allocator>::empty() const {
 
 template <typename T, typename Allocator>
 T& List<T, Allocator>::front() {
-  return head_->value;
+  return static_cast<Node*>(fake_.right)->value;
 }
 
 template <typename T, typename Allocator>
 const T& List<T, Allocator>::front() const {
-  return head_->value;
+  return static_cast<const Node*>(fake_.right)->value;
 }
 
 template <typename T, typename Allocator>
 T& List<T, Allocator>::back() {
-  return tail_->value;
+  return static_cast<Node*>(fake_.left)->value;
 }
 
 template <typename T, typename Allocator>
 const T& List<T, Allocator>::back() const {
-  return tail_->value;
+  return static_cast<const Node*>(fake_.left)->value;
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::push_back(const T& value) {
-  Node* ptr = node_alloc_traits::allocate(alloc_, 1);
-  node_alloc_traits::construct(alloc_, ptr, tail_, nullptr, value);
-  add_node_back(ptr);
+  emplace_back(value);
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::push_back(T&& value) {
-  push_back(value);
+  emplace_back(std::move(value));
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::pop_back() {
-  Node* newtail = tail_->left;
-  node_alloc_traits::destroy(alloc_, tail_);
-  node_alloc_traits::deallocate(alloc_, tail_, 1);
-  tail_ = newtail;
-  if (tail_ != nullptr) {
-    tail_->right = nullptr;
-  }
+  BaseNode* ptr = fake_.left;
+  unlink(ptr, ptr);
+  destroy_node(ptr);
   --size_;
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::push_front(const T& value) {
-  Node* ptr = node_alloc_traits::allocate(alloc_, 1);
-  node_alloc_traits::construct(alloc_, ptr, nullptr, head_, value);
-  add_node_front(ptr);
+  emplace_front(value);
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::push_front(T&& value) {
-  push_front(value);
+  emplace_front(std::move(value));
 }
 
 template <typename T, typename Allocator>
 void List<T, Allocator>::pop_front() {
-  Node* newhead = head_->right;
-  node_alloc_traits::destroy(alloc_, head_);
-  node_alloc_traits::deallocate(alloc_, head_, 1);
-  head_ = newhead;
-  if (head_ != nullptr) {
-    head_->left = nullptr;
-  }
+  BaseNode* ptr = fake_.right;
+  unlink(ptr, ptr);
+  destroy_node(ptr);
   --size_;
 }
 
+template <typename T, typename Allocator>
+template <typename... Args>
+T& List<T, Allocator>::emplace_back(Args&&... args) {
+  Node* ptr = create_node(std::forward<Args>(args)...);
+  add_node_back(ptr);
+  return ptr->value;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+T& List<T, Allocator>::emplace_front(Args&&... args) {
+  Node* ptr = create_node(std::forward<Args>(args)...);
+  add_node_front(ptr);
+  return ptr->value;
+}
+
 template <typename T, typename Allocator>
 void List<T, Allocator>::clear() noexcept {
-  if (head_ != nullptr) {
-    Node* curr = head_;
-    while (curr != tail_) {
-      Node* newcurr = curr->right;
-      node_alloc_traits::destroy(alloc_, curr);
-      node_alloc_traits::deallocate(alloc_, curr, 1);
-      curr = newcurr;
-    }
-    node_alloc_traits::destroy(alloc_, curr);
-    node_alloc_traits::deallocate(alloc_, curr, 1);
-  }
-  head_ = nullptr;
-  tail_ = nullptr;
+  BaseNode* curr = fake_.right;
+  while (curr != &fake_) {
+    BaseNode* next = curr->right;
+    destroy_node(curr);
+    curr = next;
+  }
+  reset_fake();
   size_ = 0;
 }
 
 template <typename T, typename Allocator>
 typename List<T, Allocator>::node_alloc& List<T, Allocator>::get_allocator() {
   return alloc_;
-}
\ No newline at end of file
+}
+
+template <typename T, typename Allocator>
+typename List<T, Allocator>::iterator List<T, Allocator>::insert(
+    const_iterator pos, const T& value) {
+  return emplace(pos, value);
+}
+
+template <typename T, typename Allocator>
+typename List<T, Allocator>::iterator List<T, Allocator>::insert(
+    const_iterator pos, T&& value) {
+  return emplace(pos, std::move(value));
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+typename List<T, Allocator>::iterator List<T, Allocator>::emplace(
+    const_iterator pos, Args&&... args) {
+  Node* ptr = create_node(std::forward<Args>(args)...);
+  link_before(pos.node_, ptr, ptr);
+  ++size_;
+  return iterator(ptr);
+}
+
+template <typename T, typename Allocator>
+typename List<T, Allocator>::iterator List<T, Allocator>::erase(
+    const_iterator pos) {
+  BaseNode* ptr = pos.node_;
+  BaseNode* next = ptr->right;
+  unlink(ptr, ptr);
+  destroy_node(ptr);
+  --size_;
+  return iterator(next);
+}
+
+template <typename T, typename Allocator>
+typename List<T, Allocator>::iterator List<T, Allocator>::erase(
+    const_iterator first, const_iterator last) {
+  while (first != last) {
+    first = erase(first);
+  }
+  return iterator(last.node_);
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List& other) {
+  if (other.size_ == 0 || this == &other) {
+    return;
+  }
+  BaseNode* first = other.fake_.right;
+  BaseNode* last = other.fake_.left;
+  unlink(first, last);
+  link_before(pos.node_, first, last);
+  size_ += other.size_;
+  other.size_ = 0;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List&& other) {
+  splice(pos, other);
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List& other,
+                                const_iterator iter) {
+  BaseNode* ptr = iter.node_;
+  if (ptr == pos.node_ || ptr->right == pos.node_) {
+    return;
+  }
+  unlink(ptr, ptr);
+  --other.size_;
+  link_before(pos.node_, ptr, ptr);
+  ++size_;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List&& other,
+                                const_iterator iter) {
+  splice(pos, other, iter);
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List& other,
+                                const_iterator first, const_iterator last) {
+  if (first == last) {
+    return;
+  }
+  BaseNode* first_node = first.node_;
+  BaseNode* last_node = last.node_->left;
+  if (this != &other) {
+    size_t count = std::distance(first, last);
+    other.size_ -= count;
+    size_ += count;
+  }
+  unlink(first_node, last_node);
+  link_before(pos.node_, first_node, last_node);
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::splice(const_iterator pos, List&& other,
+                                const_iterator first, const_iterator last) {
+  splice(pos, other, first, last);
+}
+
+template <typename T, typename Allocator>
+T& List<T, Allocator>::value_of(BaseNode* ptr) {
+  return static_cast<Node*>(ptr)->value;
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+void List<T, Allocator>::merge_chains(BaseNode*& first, BaseNode* second,
+                                      Compare& comp) {
+  BaseNode head;
+  BaseNode* tail = &head;
+  BaseNode* lhs = first;
+  BaseNode* rhs = second;
+  try {
+    while (lhs != nullptr && rhs != nullptr) {
+      if (comp(value_of(rhs), value_of(lhs))) {
+        tail->right = rhs;
+        rhs = rhs->right;
+      } else {
+        tail->right = lhs;
+        lhs = lhs->right;
+      }
+      tail = tail->right;
+    }
+  } catch (...) {
+    tail->right = lhs;
+    while (tail->right != nullptr) {
+      tail = tail->right;
+    }
+    tail->right = rhs;
+    first = head.right;
+    throw;
+  }
+  tail->right = (lhs != nullptr) ? lhs : rhs;
+  first = head.right;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::relink_chain(BaseNode* chain) noexcept {
+  BaseNode* prev = &fake_;
+  size_ = 0;
+  for (BaseNode* curr = chain; curr != nullptr; curr = curr->right) {
+    curr->left = prev;
+    prev->right = curr;
+    prev = curr;
+    ++size_;
+  }
+  prev->right = &fake_;
+  fake_.left = prev;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::sort() {
+  sort(std::less<>());
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+void List<T, Allocator>::sort(Compare comp) {
+  if (size_ < 2) {
+    return;
+  }
+  const size_t kBins = 64;
+  BaseNode* bins[kBins] = {};
+  size_t used = 0;
+  fake_.left->right = nullptr;
+  BaseNode* rest = fake_.right;
+  BaseNode* carry = nullptr;
+  BaseNode* result = nullptr;
+  try {
+    while (rest != nullptr) {
+      carry = rest;
+      rest = rest->right;
+      carry->right = nullptr;
+      size_t i = 0;
+      for (; bins[i] != nullptr; ++i) {
+        BaseNode* chain = std::exchange(carry, nullptr);
+        merge_chains(bins[i], chain, comp);
+        carry = std::exchange(bins[i], nullptr);
+      }
+      bins[i] = std::exchange(carry, nullptr);
+      used = std::max(used, i + 1);
+    }
+    for (size_t i = 0; i < used; ++i) {
+      if (bins[i] != nullptr) {
+        BaseNode* chain = std::exchange(result, nullptr);
+        merge_chains(bins[i], chain, comp);
+        result = std::exchange(bins[i], nullptr);
+      }
+    }
+  } catch (...) {
+    BaseNode head;
+    BaseNode* tail = &head;
+    for (BaseNode* chain : {result, carry, rest}) {
+      tail->right = chain;
+      while (tail->right != nullptr) {
+        tail = tail->right;
+      }
+    }
+    for (BaseNode* chain : bins) {
+      tail->right = chain;
+      while (tail->right != nullptr) {
+        tail = tail->right;
+      }
+    }
+    relink_chain(head.right);
+    throw;
+  }
+  relink_chain(result);
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::merge(List& other) {
+  merge(other, std::less<>());
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::merge(List&& other) {
+  merge(other, std::less<>());
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+void List<T, Allocator>::merge(List& other, Compare comp) {
+  if (this == &other) {
+    return;
+  }
+  BaseNode* curr = fake_.right;
+  BaseNode* from = other.fake_.right;
+  while (from != &other.fake_) {
+    if (curr == &fake_) {
+      BaseNode* last = other.fake_.left;
+      unlink(from, last);
+      link_before(&fake_, from, last);
+      break;
+    }
+    if (comp(value_of(from), value_of(curr))) {
+      BaseNode* last = from;
+      size_t count = 1;
+      try {
+        while (last->right != &other.fake_ &&
+               comp(value_of(last->right), value_of(curr))) {
+          last = last->right;
+          ++count;
+        }
+      } catch (...) {
+        unlink(from, last);
+        link_before(curr, from, last);
+        size_ += count;
+        other.size_ -= count;
+        throw;
+      }
+      BaseNode* next = last->right;
+      unlink(from, last);
+      link_before(curr, from, last);
+      size_ += count;
+      other.size_ -= count;
+      from = next;
+    }
+    curr = curr->right;
+  }
+  size_ += other.size_;
+  other.size_ = 0;
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+void List<T, Allocator>::merge(List&& other, Compare comp) {
+  merge(other, comp);
+}
+
+template <typename T, typename Allocator>
+size_t List<T, Allocator>::unique() {
+  return unique(std::equal_to<>());
+}
+
+template <typename T, typename Allocator>
+template <typename BinaryPredicate>
+size_t List<T, Allocator>::unique(BinaryPredicate pred) {
+  size_t removed = 0;
+  if (size_ == 0) {
+    return removed;
+  }
+  BaseNode* curr = fake_.right;
+  while (curr->right != &fake_) {
+    BaseNode* next = curr->right;
+    if (pred(value_of(curr), value_of(next))) {
+      unlink(next, next);
+      destroy_node(next);
+      --size_;
+      ++removed;
+    } else {
+      curr = next;
+    }
+  }
+  return removed;
+}
+
+template <typename T, typename Allocator>
+size_t List<T, Allocator>::remove(const T& value) {
+  return remove_if([&value](const T& elem) { return elem == value; });
+}
+
+template <typename T, typename Allocator>
+template <typename UnaryPredicate>
+size_t List<T, Allocator>::remove_if(UnaryPredicate pred) {
+  List removed(alloc_);
+  BaseNode* curr = fake_.right;
+  while (curr != &fake_) {
+    BaseNode* next = curr->right;
+    if (pred(value_of(curr))) {
+      unlink(curr, curr);
+      link_before(&removed.fake_, curr, curr);
+      --size_;
+      ++removed.size_;
+    }
+    curr = next;
+  }
+  return removed.size_;
+}
+
+template <typename T, typename Allocator>
+void List<T, Allocator>::reverse() noexcept {
+  BaseNode* curr = &fake_;
+  do {
+    std::swap(curr->left, curr->right);
+    curr = curr->left;
+  } while (curr != &fake_);
+}
+
+const size_t kUnrolledNodeBytes = 256;
+
+template <typename T, typename Allocator = std::allocator<T>>
+class UnrolledList {
+ private:
+  struct BaseNode;
+  struct Node;
+
+ public:
+  template <bool IsConst>
+  class CommonIterator;
+
+  using value_type = T;
+  using allocator_type = Allocator;
+
+  using iterator = CommonIterator<false>;
+  using const_iterator = CommonIterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using node_alloc = typename alloc_traits::template rebind_alloc<Node>;
+  using node_alloc_traits = typename alloc_traits::template rebind_traits<Node>;
+
+  static constexpr size_t kNodeCapacity =
+      std::max(size_t(4), kUnrolledNodeBytes / sizeof(T));
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+  const_reverse_iterator crbegin() const;
+  const_reverse_iterator crend() const;
+
+  UnrolledList();
+  explicit UnrolledList(const Allocator& alloc);
+  UnrolledList(size_t count, const T& value,
+               const Allocator& alloc = Allocator());
+  explicit UnrolledList(size_t count, const Allocator& alloc = Allocator());
+  UnrolledList(const UnrolledList& other);
+  UnrolledList(std::initializer_list<T> init,
+               const Allocator& alloc = Allocator());
+  UnrolledList& operator=(const UnrolledList& other);
+  ~UnrolledList();
+
+  void swap(UnrolledList& other);
+
+  size_t size() const;
+  bool empty() const;
+
+  T& front();
+  const T& front() const;
+  T& back();
+  const T& back() const;
+
+  void push_back(const T& value);
+  void push_back(T&& value);
+  void pop_back();
+  void push_front(const T& value);
+  void push_front(T&& value);
+  void pop_front();
+
+  template <typename... Args>
+  void emplace_back(Args&&... args);
+
+  iterator insert(const_iterator pos, const T& value);
+  iterator insert(const_iterator pos, T&& value);
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args);
+
+  iterator erase(const_iterator pos);
+
+  void clear() noexcept;
+  node_alloc& get_allocator();
+
+ private:
+  Node* create_node(BaseNode* pos);
+  void destroy_node(Node* node) noexcept;
+  void reset_fake() noexcept;
+  void move_to_back(Node* from, size_t first, size_t last, Node* to);
+  void move_to_front(Node* from, size_t count, Node* to);
+
+  size_t size_ = 0;
+  BaseNode fake_;
+  node_alloc alloc_;
+};
+
+template <typename T, typename Allocator>
+struct UnrolledList<T, Allocator>::BaseNode {
+  BaseNode* left = this;
+  BaseNode* right = this;
+  size_t count = 0;
+};
+
+template <typename T, typename Allocator>
+struct UnrolledList<T, Allocator>::Node : BaseNode {
+  T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+  alignas(T) unsigned char storage[sizeof(T) * kNodeCapacity];
+};
+
+template <typename T, typename Allocator>
+template <bool IsConst>
+class UnrolledList<T, Allocator>::CommonIterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = std::conditional_t<IsConst, const T, T>;
+  using pointer = std::conditional_t<IsConst, const T, T>*;
+  using reference = std::conditional_t<IsConst, const T, T>&;
+  using difference_type = std::ptrdiff_t;
+
+  CommonIterator(BaseNode* node, size_t index) : node_(node), index_(index) {}
+
+  operator CommonIterator<true>() const {
+    return CommonIterator<true>(node_, index_);
+  }
+
+  reference operator*() const {
+    return static_cast<Node*>(node_)->data()[index_];
+  }
+
+  pointer operator->() const {
+    return static_cast<Node*>(node_)->data() + index_;
+  }
+
+  CommonIterator& operator++() {
+    if (++index_ == node_->count) {
+      node_ = node_->right;
+      index_ = 0;
+    }
+    return *this;
+  }
+
+  CommonIterator operator++(int) {
+    CommonIterator prev = *this;
+    operator++();
+    return prev;
+  }
+
+  CommonIterator& operator--() {
+    if (index_ == 0) {
+      node_ = node_->left;
+      index_ = node_->count;
+    }
+    --index_;
+    return *this;
+  }
+
+  CommonIterator operator--(int) {
+    CommonIterator prev = *this;
+    operator--();
+    return prev;
+  }
+
+  bool operator==(const CommonIterator& other) const {
+    return node_ == other.node_ && index_ == other.index_;
+  }
+
+  bool operator!=(const CommonIterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  friend UnrolledList;
+
+  BaseNode* node_;
+  size_t index_;
+};
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::reset_fake() noexcept {
+  fake_.left = &fake_;
+  fake_.right = &fake_;
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::Node*
+UnrolledList<T, Allocator>::create_node(BaseNode* pos) {
+  Node* node = node_alloc_traits::allocate(alloc_, 1);
+  ::new (static_cast<void*>(node)) Node();
+  node->left = pos->left;
+  node->right = pos;
+  pos->left->right = node;
+  pos->left = node;
+  return node;
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::destroy_node(Node* node) noexcept {
+  T* data = node->data();
+  for (size_t i = 0; i < node->count; ++i) {
+    node_alloc_traits::destroy(alloc_, data + i);
+  }
+  node->left->right = node->right;
+  node->right->left = node->left;
+  node->~Node();
+  node_alloc_traits::deallocate(alloc_, node, 1);
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList() {
+  alloc_ = Allocator();
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList(const Allocator& alloc) {
+  alloc_ = alloc;
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList(size_t count, const T& value,
+                                         const Allocator& alloc) {
+  alloc_ = alloc;
+  try {
+    for (size_t i = 0; i < count; ++i) {
+      emplace_back(value);
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList(size_t count, const Allocator& alloc) {
+  alloc_ = alloc;
+  try {
+    for (size_t i = 0; i < count; ++i) {
+      emplace_back();
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList(const UnrolledList& other) {
+  alloc_ =
+      node_alloc_traits::select_on_container_copy_construction(other.alloc_);
+  try {
+    for (const auto& elem : other) {
+      emplace_back(elem);
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::UnrolledList(std::initializer_list<T> init,
+                                         const Allocator& alloc) {
+  alloc_ = alloc;
+  try {
+    for (const auto& elem : init) {
+      emplace_back(elem);
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>& UnrolledList<T, Allocator>::operator=(
+    const UnrolledList& other) {
+  if (this == &other) {
+    return *this;
+  }
+  UnrolledList copy(other);
+  swap(copy);
+  return *this;
+}
+
+template <typename T, typename Allocator>
+UnrolledList<T, Allocator>::~UnrolledList() {
+  clear();
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::swap(UnrolledList& other) {
+  std::swap(fake_, other.fake_);
+  std::swap(size_, other.size_);
+  std::swap(alloc_, other.alloc_);
+  for (UnrolledList* list : {this, &other}) {
+    if (list->size_ == 0) {
+      list->reset_fake();
+    } else {
+      list->fake_.left->right = &list->fake_;
+      list->fake_.right->left = &list->fake_;
+    }
+  }
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::iterator
+UnrolledList<T, Allocator>::begin() {
+  return iterator(fake_.right, 0);
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::iterator UnrolledList<T, Allocator>::end() {
+  return iterator(&fake_, 0);
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_iterator
+UnrolledList<T, Allocator>::begin() const {
+  return const_iterator(fake_.right, 0);
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_iterator
+UnrolledList<T, Allocator>::end() const {
+  return const_iterator(const_cast<BaseNode*>(&fake_), 0);
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_iterator
+UnrolledList<T, Allocator>::cbegin() const {
+  return begin();
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_iterator
+UnrolledList<T, Allocator>::cend() const {
+  return end();
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::reverse_iterator
+UnrolledList<T, Allocator>::rbegin() {
+  return std::reverse_iterator(end());
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::reverse_iterator
+UnrolledList<T, Allocator>::rend() {
+  return std::reverse_iterator(begin());
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_reverse_iterator
+UnrolledList<T, Allocator>::crbegin() const {
+  return const_reverse_iterator(cend());
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::const_reverse_iterator
+UnrolledList<T, Allocator>::crend() const {
+  return const_reverse_iterator(cbegin());
+}
+
+template <typename T, typename Allocator>
+size_t UnrolledList<T, Allocator>::size() const {
+  return size_;
+}
+
+template <typename T, typename Allocator>
+bool UnrolledList<T, Allocator>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T, typename Allocator>
+T& UnrolledList<T, Allocator>::front() {
+  return *begin();
+}
+
+template <typename T, typename Allocator>
+const T& UnrolledList<T, Allocator>::front() const {
+  return *begin();
+}
+
+template <typename T, typename Allocator>
+T& UnrolledList<T, Allocator>::back() {
+  return *--end();
+}
+
+template <typename T, typename Allocator>
+const T& UnrolledList<T, Allocator>::back() const {
+  return *--end();
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+void UnrolledList<T, Allocator>::emplace_back(Args&&... args) {
+  BaseNode* tail = fake_.left;
+  Node* node = (tail != &fake_ && tail->count != kNodeCapacity)
+                   ? static_cast<Node*>(tail)
+                   : nullptr;
+  bool fresh = node == nullptr;
+  if (fresh) {
+    node = create_node(&fake_);
+  }
+  try {
+    node_alloc_traits::construct(alloc_, node->data() + node->count,
+                                 std::forward<Args>(args)...);
+  } catch (...) {
+    if (fresh) {
+      destroy_node(node);
+    }
+    throw;
+  }
+  ++node->count;
+  ++size_;
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::push_back(const T& value) {
+  emplace_back(value);
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::push_back(T&& value) {
+  emplace_back(std::move(value));
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::pop_back() {
+  erase(--end());
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::push_front(const T& value) {
+  emplace(begin(), value);
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::push_front(T&& value) {
+  emplace(begin(), std::move(value));
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::pop_front() {
+  erase(begin());
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::clear() noexcept {
+  while (fake_.right != &fake_) {
+    destroy_node(static_cast<Node*>(fake_.right));
+  }
+  size_ = 0;
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::node_alloc&
+UnrolledList<T, Allocator>::get_allocator() {
+  return alloc_;
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::iterator
+UnrolledList<T, Allocator>::insert(const_iterator pos, const T& value) {
+  return emplace(pos, value);
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::iterator
+UnrolledList<T, Allocator>::insert(const_iterator pos, T&& value) {
+  return emplace(pos, std::move(value));
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+typename UnrolledList<T, Allocator>::iterator
+UnrolledList<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
+  BaseNode* base = pos.node_;
+  size_t index = pos.index_;
+  Node* fresh = nullptr;
+  if (base == &fake_ || (index == 0 && base->left != &fake_ &&
+                         base->left->count != kNodeCapacity)) {
+    if (base->left == &fake_ || base->left->count == kNodeCapacity) {
+      fresh = create_node(base);
+    }
+    base = base->left;
+    index = base->count;
+  }
+  Node* node = static_cast<Node*>(base);
+  if (node->count == kNodeCapacity) {
+    Node* next = create_node(node->right);
+    size_t half = kNodeCapacity / 2;
+    T* data = node->data();
+    try {
+      for (size_t i = half; i < kNodeCapacity; ++i) {
+        node_alloc_traits::construct(alloc_, next->data() + next->count,
+                                     std::move_if_noexcept(data[i]));
+        ++next->count;
+      }
+    } catch (...) {
+      destroy_node(next);
+      throw;
+    }
+    for (size_t i = half; i < kNodeCapacity; ++i) {
+      node_alloc_traits::destroy(alloc_, data + i);
+    }
+    node->count = half;
+    if (index > half) {
+      node = next;
+      index -= half;
+    }
+  }
+  T* data = node->data();
+  if (index == node->count) {
+    try {
+      node_alloc_traits::construct(alloc_, data + index,
+                                   std::forward<Args>(args)...);
+    } catch (...) {
+      // Only an element-less node may be dropped; a split stays valid.
+      if (fresh != nullptr) {
+        destroy_node(fresh);
+      }
+      throw;
+    }
+    ++node->count;
+    ++size_;
+  } else {
+    T value(std::forward<Args>(args)...);
+    node_alloc_traits::construct(alloc_, data + node->count,
+                                 std::move(data[node->count - 1]));
+    ++node->count;
+    ++size_;
+    std::move_backward(data + index, data + node->count - 2,
+                       data + node->count - 1);
+    data[index] = std::move(value);
+  }
+  return iterator(node, index);
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::move_to_back(Node* from, size_t first,
+                                              size_t last, Node* to) {
+  T* data = from->data();
+  for (size_t i = first; i < last; ++i) {
+    node_alloc_traits::construct(alloc_, to->data() + to->count,
+                                 std::move(data[i]));
+    ++to->count;
+  }
+  std::move(data + last, data + from->count, data + first);
+  for (size_t i = from->count - (last - first); i < from->count; ++i) {
+    node_alloc_traits::destroy(alloc_, data + i);
+  }
+  from->count -= last - first;
+}
+
+template <typename T, typename Allocator>
+void UnrolledList<T, Allocator>::move_to_front(Node* from, size_t count,
+                                               Node* to) {
+  T* data = to->data();
+  for (size_t i = to->count; i-- > 0;) {
+    if (i + count >= to->count) {
+      node_alloc_traits::construct(alloc_, data + i + count,
+                                   std::move(data[i]));
+    } else {
+      data[i + count] = std::move(data[i]);
+    }
+  }
+  T* source = from->data() + from->count - count;
+  for (size_t i = 0; i < count; ++i) {
+    if (i < to->count) {
+      data[i] = std::move(source[i]);
+    } else {
+      node_alloc_traits::construct(alloc_, data + i, std::move(source[i]));
+    }
+    node_alloc_traits::destroy(alloc_, source + i);
+  }
+  from->count -= count;
+  to->count += count;
+}
+
+template <typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::iterator UnrolledList<T, Allocator>::erase(
+    const_iterator pos) {
+  Node* node = static_cast<Node*>(pos.node_);
+  size_t index = pos.index_;
+  T* data = node->data();
+  std::move(data + index + 1, data + node->count, data + index);
+  node_alloc_traits::destroy(alloc_, data + node->count - 1);
+  --node->count;
+  --size_;
+  if (node->count == 0) {
+    BaseNode* next = node->right;
+    destroy_node(node);
+    return iterator(next, 0);
+  }
+  if (node->count < kNodeCapacity / 2) {
+    BaseNode* left = node->left;
+    BaseNode* right = node->right;
+    if (left != &fake_ && left->count + node->count <= kNodeCapacity) {
+      Node* prev = static_cast<Node*>(left);
+      size_t offset = prev->count;
+      bool at_end = index == node->count;
+      move_to_back(node, 0, node->count, prev);
+      destroy_node(node);
+      return at_end ? iterator(right, 0) : iterator(prev, offset + index);
+    }
+    if (right != &fake_ && node->count + right->count <= kNodeCapacity) {
+      Node* next = static_cast<Node*>(right);
+      move_to_back(next, 0, next->count, node);
+      destroy_node(next);
+    } else if (left != &fake_) {
+      size_t count = (left->count - node->count) / 2;
+      move_to_front(static_cast<Node*>(left), count, node);
+      index += count;
+    } else if (right != &fake_) {
+      size_t count = (right->count - node->count) / 2;
+      move_to_back(static_cast<Node*>(right), 0, count, node);
+    }
+  }
+  if (index == node->count) {
+    return iterator(node->right, 0);
+  }
+  return iterator(node, index);
+}
+
+class ListHook {
+ public:
+  ListHook() = default;
+  ListHook(const ListHook& /*other*/) {}
+  ListHook& operator=(const ListHook& /*other*/) { return *this; }
+
+  bool is_linked() const { return right_ != this; }
+
+ private:
+  template <typename T>
+  friend class IntrusiveList;
+
+  ListHook* left_ = this;
+  ListHook* right_ = this;
+};
+
+template <typename T>
+class IntrusiveList {
+  static_assert(std::is_base_of_v<ListHook, T>,
+                "elements of IntrusiveList must derive from ListHook");
+
+ public:
+  template <bool IsConst>
+  class CommonIterator;
+
+  using value_type = T;
+
+  using iterator = CommonIterator<false>;
+  using const_iterator = CommonIterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+  const_reverse_iterator crbegin() const;
+  const_reverse_iterator crend() const;
+
+  IntrusiveList() = default;
+  IntrusiveList(const IntrusiveList& other) = delete;
+  IntrusiveList(IntrusiveList&& other) noexcept;
+  IntrusiveList& operator=(const IntrusiveList& other) = delete;
+  IntrusiveList& operator=(IntrusiveList&& other) noexcept;
+  ~IntrusiveList();
+
+  void swap(IntrusiveList& other) noexcept;
+
+  size_t size() const;
+  bool empty() const;
+
+  T& front();
+  const T& front() const;
+  T& back();
+  const T& back() const;
+
+  void push_back(T& obj);
+  void pop_back();
+  void push_front(T& obj);
+  void pop_front();
+
+  iterator insert(const_iterator pos, T& obj);
+  iterator erase(const_iterator pos);
+  void erase(T& obj);
+
+  iterator iterator_to(T& obj);
+  const_iterator iterator_to(const T& obj) const;
+
+  void clear() noexcept;
+
+ private:
+  static void link_before(ListHook* pos, ListHook* ptr);
+  static void unlink(ListHook* ptr);
+  void fix_fake() noexcept;
+
+  size_t size_ = 0;
+  ListHook fake_;
+};
+
+template <typename T>
+template <bool IsConst>
+class IntrusiveList<T>::CommonIterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = std::conditional_t<IsConst, const T, T>;
+  using pointer = std::conditional_t<IsConst, const T, T>*;
+  using reference = std::conditional_t<IsConst, const T, T>&;
+  using difference_type = std::ptrdiff_t;
+
+  explicit CommonIterator(ListHook* node) : node_(node) {}
+
+  operator CommonIterator<true>() const { return CommonIterator<true>(node_); }
+
+  reference operator*() const { return *static_cast<T*>(node_); }
+
+  pointer operator->() const { return static_cast<T*>(node_); }
+
+  CommonIterator& operator++() {
+    node_ = node_->right_;
+    return *this;
+  }
+
+  CommonIterator operator++(int) {
+    CommonIterator prev = *this;
+    operator++();
+    return prev;
+  }
+
+  CommonIterator& operator--() {
+    node_ = node_->left_;
+    return *this;
+  }
+
+  CommonIterator operator--(int) {
+    CommonIterator prev = *this;
+    operator--();
+    return prev;
+  }
+
+  bool operator==(const CommonIterator& other) const {
+    return node_ == other.node_;
+  }
+
+  bool operator!=(const CommonIterator& other) const {
+    return node_ != other.node_;
+  }
+
+ private:
+  friend IntrusiveList;
+
+  ListHook* node_;
+};
+
+template <typename T>
+void IntrusiveList<T>::link_before(ListHook* pos, ListHook* ptr) {
+  ptr->left_ = pos->left_;
+  ptr->right_ = pos;
+  pos->left_->right_ = ptr;
+  pos->left_ = ptr;
+}
+
+template <typename T>
+void IntrusiveList<T>::unlink(ListHook* ptr) {
+  ptr->left_->right_ = ptr->right_;
+  ptr->right_->left_ = ptr->left_;
+  ptr->left_ = ptr;
+  ptr->right_ = ptr;
+}
+
+template <typename T>
+void IntrusiveList<T>::fix_fake() noexcept {
+  if (size_ == 0) {
+    fake_.left_ = &fake_;
+    fake_.right_ = &fake_;
+  } else {
+    fake_.left_->right_ = &fake_;
+    fake_.right_->left_ = &fake_;
+  }
+}
+
+template <typename T>
+IntrusiveList<T>::IntrusiveList(IntrusiveList&& other) noexcept {
+  swap(other);
+}
+
+template <typename T>
+IntrusiveList<T>& IntrusiveList<T>::operator=(IntrusiveList&& other) noexcept {
+  if (this != &other) {
+    clear();
+    swap(other);
+  }
+  return *this;
+}
+
+template <typename T>
+IntrusiveList<T>::~IntrusiveList() {
+  clear();
+}
+
+template <typename T>
+void IntrusiveList<T>::swap(IntrusiveList& other) noexcept {
+  std::swap(fake_.left_, other.fake_.left_);
+  std::swap(fake_.right_, other.fake_.right_);
+  std::swap(size_, other.size_);
+  fix_fake();
+  other.fix_fake();
+}
+
+template <typename T>
+typename IntrusiveList<T>::iterator IntrusiveList<T>::begin() {
+  return iterator(fake_.right_);
+}
+
+template <typename T>
+typename IntrusiveList<T>::iterator IntrusiveList<T>::end() {
+  return iterator(&fake_);
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_iterator IntrusiveList<T>::begin() const {
+  return const_iterator(fake_.right_);
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_iterator IntrusiveList<T>::end() const {
+  return const_iterator(const_cast<ListHook*>(&fake_));
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_iterator IntrusiveList<T>::cbegin() const {
+  return begin();
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_iterator IntrusiveList<T>::cend() const {
+  return end();
+}
+
+template <typename T>
+typename IntrusiveList<T>::reverse_iterator IntrusiveList<T>::rbegin() {
+  return std::reverse_iterator(end());
+}
+
+template <typename T>
+typename IntrusiveList<T>::reverse_iterator IntrusiveList<T>::rend() {
+  return std::reverse_iterator(begin());
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_reverse_iterator IntrusiveList<T>::crbegin()
+    const {
+  return const_reverse_iterator(cend());
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_reverse_iterator IntrusiveList<T>::crend()
+    const {
+  return const_reverse_iterator(cbegin());
+}
+
+template <typename T>
+size_t IntrusiveList<T>::size() const {
+  return size_;
+}
+
+template <typename T>
+bool IntrusiveList<T>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T>
+T& IntrusiveList<T>::front() {
+  return *static_cast<T*>(fake_.right_);
+}
+
+template <typename T>
+const T& IntrusiveList<T>::front() const {
+  return *static_cast<const T*>(fake_.right_);
+}
+
+template <typename T>
+T& IntrusiveList<T>::back() {
+  return *static_cast<T*>(fake_.left_);
+}
+
+template <typename T>
+const T& IntrusiveList<T>::back() const {
+  return *static_cast<const T*>(fake_.left_);
+}
+
+template <typename T>
+void IntrusiveList<T>::push_back(T& obj) {
+  link_before(&fake_, &obj);
+  ++size_;
+}
+
+template <typename T>
+void IntrusiveList<T>::pop_back() {
+  unlink(fake_.left_);
+  --size_;
+}
+
+template <typename T>
+void IntrusiveList<T>::push_front(T& obj) {
+  link_before(fake_.right_, &obj);
+  ++size_;
+}
+
+template <typename T>
+void IntrusiveList<T>::pop_front() {
+  unlink(fake_.right_);
+  --size_;
+}
+
+template <typename T>
+typename IntrusiveList<T>::iterator IntrusiveList<T>::insert(const_iterator pos,
+                                                             T& obj) {
+  link_before(pos.node_, &obj);
+  ++size_;
+  return iterator(&obj);
+}
+
+template <typename T>
+typename IntrusiveList<T>::iterator IntrusiveList<T>::erase(
+    const_iterator pos) {
+  ListHook* next = pos.node_->right_;
+  unlink(pos.node_);
+  --size_;
+  return iterator(next);
+}
+
+template <typename T>
+void IntrusiveList<T>::erase(T& obj) {
+  unlink(&obj);
+  --size_;
+}
+
+template <typename T>
+typename IntrusiveList<T>::iterator IntrusiveList<T>::iterator_to(T& obj) {
+  return iterator(&obj);
+}
+
+template <typename T>
+typename IntrusiveList<T>::const_iterator IntrusiveList<T>::iterator_to(
+    const T& obj) const {
+  return const_iterator(const_cast<T*>(&obj));
+}
+
+template <typename T>
+void IntrusiveList<T>::clear() noexcept {
+  while (fake_.right_ != &fake_) {
+    unlink(fake_.right_);
+  }
+  size_ = 0;
+}
+
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentList {
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+
+  using list_type = List<T, Allocator>;
+  using node_alloc = typename list_type::node_alloc;
+  using node_alloc_traits = typename list_type::node_alloc_traits;
+
+  ConcurrentList();
+  explicit ConcurrentList(const Allocator& alloc);
+  ConcurrentList(const ConcurrentList& other) = delete;
+  ConcurrentList& operator=(const ConcurrentList& other) = delete;
+  ~ConcurrentList();
+
+  bool empty() const;
+
+  void push_back(const T& value);
+  void push_back(T&& value);
+  void push_front(const T& value);
+  void push_front(T&& value);
+
+  template <typename... Args>
+  void emplace_back(Args&&... args);
+  template <typename... Args>
+  void emplace_front(Args&&... args);
+
+  list_type take_all();
+
+ private:
+  using BaseNode = typename list_type::BaseNode;
+  using Node = typename list_type::Node;
+
+  template <typename... Args>
+  void push(bool to_back, Args&&... args);
+
+  std::atomic<BaseNode*> head_ = nullptr;
+  node_alloc alloc_;
+};
+
+template <typename T, typename Allocator>
+ConcurrentList<T, Allocator>::ConcurrentList() : alloc_(Allocator()) {}
+
+template <typename T, typename Allocator>
+ConcurrentList<T, Allocator>::ConcurrentList(const Allocator& alloc)
+    : alloc_(alloc) {}
+
+template <typename T, typename Allocator>
+ConcurrentList<T, Allocator>::~ConcurrentList() {
+  take_all();
+}
+
+template <typename T, typename Allocator>
+bool ConcurrentList<T, Allocator>::empty() const {
+  return head_.load(std::memory_order_acquire) == nullptr;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+void ConcurrentList<T, Allocator>::push(bool to_back, Args&&... args) {
+  Node* ptr = node_alloc_traits::allocate(alloc_, 1);
+  try {
+    node_alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+  } catch (...) {
+    node_alloc_traits::deallocate(alloc_, ptr, 1);
+    throw;
+  }
+  ptr->left = to_back ? ptr : nullptr;
+  BaseNode* head = head_.load(std::memory_order_relaxed);
+  do {
+    ptr->right = head;
+  } while (!head_.compare_exchange_weak(head, ptr, std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+template <typename T, typename Allocator>
+void ConcurrentList<T, Allocator>::push_back(const T& value) {
+  push(true, value);
+}
+
+template <typename T, typename Allocator>
+void ConcurrentList<T, Allocator>::push_back(T&& value) {
+  push(true, std::move(value));
+}
+
+template <typename T, typename Allocator>
+void ConcurrentList<T, Allocator>::push_front(const T& value) {
+  push(false, value);
+}
+
+template <typename T, typename Allocator>
+void ConcurrentList<T, Allocator>::push_front(T&& value) {
+  push(false, std::move(value));
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+void ConcurrentList<T, Allocator>::emplace_back(Args&&... args) {
+  push(true, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+void ConcurrentList<T, Allocator>::emplace_front(Args&&... args) {
+  push(false, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator>
+typename ConcurrentList<T, Allocator>::list_type
+ConcurrentList<T, Allocator>::take_all() {
+  list_type result(alloc_);
+  BaseNode* curr = head_.exchange(nullptr, std::memory_order_acquire);
+  BaseNode* boundary = &result.fake_;
+  while (curr != nullptr) {
+    BaseNode* next = curr->right;
+    bool to_back = curr->left != nullptr;
+    list_type::link_before(boundary, curr, curr);
+    if (to_back) {
+      boundary = curr;
+    }
+    ++result.size_;
+    curr = next;
+  }
+  return result;
+}
@@ -0,0 +1,183 @@
+// g++ -std=c++20 -O2 -DNDEBUG list_bench.cpp && ./a.out [max_count]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <string>
+
+#include "list.hpp"
+
+namespace {
+
+size_t allocations = 0;
+size_t counted_calls = 0;
+size_t counted_bytes = 0;
+volatile uint64_t sink = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    ++counted_calls;
+    counted_bytes += count * sizeof(T);
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* ptr, size_t count) {
+    std::allocator<T>().deallocate(ptr, count);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U>&) const {
+    return true;
+  }
+};
+
+template <size_t kBytes>
+struct Blob {
+  Blob() = default;
+  Blob(uint64_t key) : key(key) {}
+
+  uint64_t key = 0;
+  std::array<char, kBytes - sizeof(uint64_t)> pad{};
+};
+
+template <typename Allocator>
+constexpr bool kCounting = false;
+
+template <typename T>
+constexpr bool kCounting<CountingAllocator<T>> = true;
+
+class Timer {
+ public:
+  Timer(const char* container, const char* allocator, const char* element,
+        size_t count, bool counting)
+      : container_(container),
+        allocator_(allocator),
+        element_(element),
+        count_(count),
+        counting_(counting) {}
+
+  template <typename Func>
+  void run(const char* op, Func func) {
+    size_t before = allocations;
+    size_t calls_before = counted_calls;
+    size_t bytes_before = counted_bytes;
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf("%-12s %-8s %-6s %-10s %9zu %9.2f %9.2f %9.3f", container_,
+                allocator_, element_, op, count_, ns / count_,
+                count_ * 1e3 / ns,
+                static_cast<double>(allocations - before) / count_);
+    if (counting_) {
+      std::printf(" %9.3f %9.1f\n",
+                  static_cast<double>(counted_calls - calls_before) / count_,
+                  static_cast<double>(counted_bytes - bytes_before) / count_);
+    } else {
+      std::printf(" %9s %9s\n", "-", "-");
+    }
+  }
+
+ private:
+  const char* container_;
+  const char* allocator_;
+  const char* element_;
+  size_t count_;
+  bool counting_;
+};
+
+template <typename Container>
+void Bench(const char* name, const char* allocator, const char* element,
+           size_t count) {
+  using T = typename Container::value_type;
+  Timer timer(name, allocator, element, count,
+              kCounting<typename Container::allocator_type>);
+  Container container;
+  timer.run("push_back", [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.push_back(T(i));
+    }
+  });
+  timer.run("traverse", [&] {
+    uint64_t sum = 0;
+    for (const T& elem : container) {
+      sum += elem.key;
+    }
+    sink = sink + sum;
+  });
+  timer.run("copy", [&] {
+    Container copy(container);
+    sink = sink + copy.size();
+  });
+  timer.run("pop_back", [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.pop_back();
+      sink = sink + container.size();
+    }
+  });
+  timer.run("push_front", [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.push_front(T(i));
+    }
+  });
+  timer.run("pop_front", [&] {
+    for (size_t i = 0; i < count; ++i) {
+      container.pop_front();
+      sink = sink + container.size();
+    }
+  });
+  for (size_t i = 0; i < count; ++i) {
+    container.push_back(T(i));
+  }
+  timer.run("clear", [&] { container.clear(); });
+}
+
+template <template <typename, typename> class Container, typename T>
+void BenchAllocators(const char* name, const char* element, size_t count) {
+  Bench<Container<T, std::allocator<T>>>(name, "std", element, count);
+  Bench<Container<T, PoolAllocator<T>>>(name, "pool", element, count);
+  Bench<Container<T, CountingAllocator<T>>>(name, "counting", element, count);
+}
+
+template <typename T>
+void BenchElement(const char* element, size_t max_count) {
+  for (size_t count = 10; count <= max_count; count *= 10) {
+    BenchAllocators<List, T>("List", element, count);
+    BenchAllocators<UnrolledList, T>("UnrolledList", element, count);
+    BenchAllocators<std::list, T>("std_list", element, count);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t max_count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+  std::printf("%-12s %-8s %-6s %-10s %9s %9s %9s %9s %9s %9s\n", "container",
+              "alloc", "elem", "op", "count", "ns/op", "Mops/s", "new/op",
+              "calls/op", "bytes/op");
+  BenchElement<Blob<8>>("8B", max_count);
+  BenchElement<Blob<64>>("64B", max_count);
+}
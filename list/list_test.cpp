@@ -0,0 +1,77 @@
+// g++ -std=c++20 -O2 list_test.cpp && ./a.out
+#include <cassert>
+#include <iterator>
+#include <stdexcept>
+
+#include "list.hpp"
+
+struct Throwing {
+  Throwing(int value, bool fail) : value(value) {
+    if (fail) {
+      throw std::runtime_error("Throwing");
+    }
+  }
+
+  int value;
+};
+
+template <typename Container>
+void CheckConsistent(const Container& list) {
+  size_t count = 0;
+  for (auto it = list.begin(); it != list.end(); ++it) {
+    assert(count < list.size());
+    ++count;
+  }
+  assert(count == list.size());
+  assert(list.empty() == (list.begin() == list.end()));
+}
+
+template <typename Container, typename Emplace>
+void ExpectThrow(Container& list, Emplace emplace) {
+  size_t before = list.size();
+  bool thrown = false;
+  try {
+    emplace();
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(list.size() == before);
+  CheckConsistent(list);
+}
+
+void TestUnrolledEmplaceThrowsIntoEmpty() {
+  UnrolledList<Throwing> list;
+  ExpectThrow(list, [&] { list.emplace(list.end(), 0, true); });
+  ExpectThrow(list, [&] { list.emplace(list.begin(), 0, true); });
+  assert(list.begin() == list.end());
+  list.emplace(list.end(), 1, false);
+  assert(list.size() == 1 && list.front().value == 1);
+}
+
+void TestUnrolledEmplaceThrowsAtFullNode() {
+  using List = UnrolledList<Throwing>;
+  const size_t kCount = 2 * List::kNodeCapacity;
+  List list;
+  for (size_t i = 0; i < kCount; ++i) {
+    list.emplace_back(static_cast<int>(i), false);
+  }
+  ExpectThrow(list, [&] { list.emplace(list.end(), -1, true); });
+  ExpectThrow(list, [&] { list.emplace_back(-1, true); });
+  ExpectThrow(list, [&] { list.emplace(list.begin(), -1, true); });
+  auto middle = std::next(list.begin(), static_cast<long>(kCount / 2));
+  ExpectThrow(list, [&] { list.emplace(middle, -1, true); });
+  int expected = 0;
+  for (const Throwing& item : list) {
+    assert(item.value == expected++);
+  }
+  list.emplace(list.end(), static_cast<int>(kCount), false);
+  assert(list.back().value == static_cast<int>(kCount));
+  CheckConsistent(list);
+}
+
+int main() {
+  TestUnrolledEmplaceThrowsIntoEmpty();
+  TestUnrolledEmplaceThrowsAtFullNode();
+  std::cout << "OK\n";
+}
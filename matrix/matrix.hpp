@@ -1,166 +1,1894 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+inline constexpr size_t kMatrixInlineBytes = 4096;
+inline constexpr size_t kMatrixAlignment = 64;
+
+template <typename T>
+class MatrixBuffer {
+ public:
+  MatrixBuffer() = default;
+  explicit MatrixBuffer(size_t size);
+  MatrixBuffer(const MatrixBuffer& other);
+  MatrixBuffer(MatrixBuffer&& other) noexcept;
+  MatrixBuffer& operator=(const MatrixBuffer& other);
+  MatrixBuffer& operator=(MatrixBuffer&& other) noexcept;
+  ~MatrixBuffer();
+
+  void swap(MatrixBuffer& other) noexcept;
+
+  size_t size() const { return size_; }
+  T* data() { return ptr_; }
+  const T* data() const { return ptr_; }
+
+ private:
+  static constexpr std::align_val_t kAlign{
+      std::max(kMatrixAlignment, alignof(T))};
+
+  static T* allocate(size_t size);
+  static void deallocate(T* ptr);
+
+  T* ptr_ = nullptr;
+  size_t size_ = 0;
+};
+
+template <typename T>
+T* MatrixBuffer<T>::allocate(size_t size) {
+  return static_cast<T*>(::operator new(size * sizeof(T), kAlign));
+}
+
+template <typename T>
+void MatrixBuffer<T>::deallocate(T* ptr) {
+  ::operator delete(ptr, kAlign);
+}
+
+template <typename T>
+MatrixBuffer<T>::MatrixBuffer(size_t size) : ptr_(allocate(size)) {
+  try {
+    std::uninitialized_value_construct_n(ptr_, size);
+  } catch (...) {
+    deallocate(ptr_);
+    throw;
+  }
+  size_ = size;
+}
+
+template <typename T>
+MatrixBuffer<T>::MatrixBuffer(const MatrixBuffer& other)
+    : ptr_(allocate(other.size_)) {
+  try {
+    std::uninitialized_copy_n(other.ptr_, other.size_, ptr_);
+  } catch (...) {
+    deallocate(ptr_);
+    throw;
+  }
+  size_ = other.size_;
+}
+
+template <typename T>
+MatrixBuffer<T>::MatrixBuffer(MatrixBuffer&& other) noexcept
+    : ptr_(std::exchange(other.ptr_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+template <typename T>
+MatrixBuffer<T>& MatrixBuffer<T>::operator=(const MatrixBuffer& other) {
+  if (this == &other) {
+    return *this;
+  }
+  if (size_ == other.size_) {
+    std::copy_n(other.ptr_, size_, ptr_);
+  } else {
+    MatrixBuffer copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T>
+MatrixBuffer<T>& MatrixBuffer<T>::operator=(MatrixBuffer&& other) noexcept {
+  swap(other);
+  return *this;
+}
+
+template <typename T>
+MatrixBuffer<T>::~MatrixBuffer() {
+  if (ptr_ != nullptr) {
+    std::destroy_n(ptr_, size_);
+    deallocate(ptr_);
+  }
+}
+
+template <typename T>
+void MatrixBuffer<T>::swap(MatrixBuffer& other) noexcept {
+  std::swap(ptr_, other.ptr_);
+  std::swap(size_, other.size_);
+}
+
+template <typename T, size_t kSize,
+          bool kInline = kSize * sizeof(T) <= kMatrixInlineBytes>
+class MatrixStorage {
+ public:
+  constexpr T* data() { return arr_.data(); }
+  constexpr const T* data() const { return arr_.data(); }
+
+ private:
+  std::array<T, kSize> arr_{};
+};
+
+template <typename T, size_t kSize>
+class MatrixStorage<T, kSize, false> {
+ public:
+  T* data() { return buffer_.data(); }
+  const T* data() const { return buffer_.data(); }
+
+ private:
+  MatrixBuffer<T> buffer_{kSize};
+};
+
+enum class MatrixExecution { kSerial, kParallel, kAuto };
+
+class MatrixThreadPool {
+ public:
+  static constexpr size_t kMinParallelWork = size_t(1) << 12;
+  static constexpr size_t kAutoParallelWork = size_t(1) << 18;
+
+  explicit MatrixThreadPool(size_t workers);
+  MatrixThreadPool(const MatrixThreadPool& other) = delete;
+  MatrixThreadPool& operator=(const MatrixThreadPool& other) = delete;
+  ~MatrixThreadPool();
+
+  static MatrixThreadPool& Instance();
+  static void SetExecution(MatrixExecution mode);
+  static MatrixExecution Execution();
+  static bool ShouldParallelize(size_t work);
+
+  template <typename Func>
+  static void ForEachChunk(size_t count, Func func);
+
+  size_t Concurrency() const;
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+ private:
+  struct Batch {
+    std::atomic<size_t> next = 0;
+    size_t count = 0;
+    size_t done = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  static void Drain(Batch& batch, const std::function<void(size_t)>& func);
+  void WorkerLoop();
+
+  static inline std::atomic<MatrixExecution> execution_ =
+      MatrixExecution::kAuto;
+  static inline thread_local bool in_parallel_ = false;
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> jobs_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
+
+inline MatrixThreadPool::MatrixThreadPool(size_t workers) {
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+inline MatrixThreadPool::~MatrixThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+inline MatrixThreadPool& MatrixThreadPool::Instance() {
+  static MatrixThreadPool pool(
+      std::max(std::thread::hardware_concurrency(), 1U) - 1);
+  return pool;
+}
+
+inline void MatrixThreadPool::SetExecution(MatrixExecution mode) {
+  execution_.store(mode, std::memory_order_relaxed);
+}
+
+inline MatrixExecution MatrixThreadPool::Execution() {
+  return execution_.load(std::memory_order_relaxed);
+}
+
+inline bool MatrixThreadPool::ShouldParallelize(size_t work) {
+  if (in_parallel_) {
+    return false;
+  }
+  switch (Execution()) {
+    case MatrixExecution::kSerial:
+      return false;
+    case MatrixExecution::kParallel:
+      return Instance().Concurrency() > 1;
+    case MatrixExecution::kAuto:
+      return work >= kAutoParallelWork && Instance().Concurrency() > 1;
+  }
+  return false;
+}
+
+template <typename Func>
+void MatrixThreadPool::ForEachChunk(size_t count, Func func) {
+  if (count < kMinParallelWork || !ShouldParallelize(count)) {
+    func(0, count);
+    return;
+  }
+  MatrixThreadPool& pool = Instance();
+  size_t parts = pool.Concurrency();
+  size_t step = (count + parts - 1) / parts;
+  pool.ParallelFor(parts, [&](size_t part) {
+    func(std::min(part * step, count), std::min((part + 1) * step, count));
+  });
+}
+
+inline size_t MatrixThreadPool::Concurrency() const {
+  return workers_.size() + 1;
+}
+
+inline void MatrixThreadPool::Drain(Batch& batch,
+                                    const std::function<void(size_t)>& func) {
+  size_t finished = 0;
+  std::exception_ptr error;
+  for (size_t idx = batch.next.fetch_add(1); idx < batch.count;
+       idx = batch.next.fetch_add(1)) {
+    try {
+      func(idx);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    ++finished;
+  }
+  if (finished == 0) {
+    return;
+  }
+  std::lock_guard lock(batch.mutex);
+  if (error && !batch.error) {
+    batch.error = error;
+  }
+  batch.done += finished;
+  if (batch.done == batch.count) {
+    batch.finished.notify_all();
+  }
+}
+
+inline void MatrixThreadPool::ParallelFor(
+    size_t count, const std::function<void(size_t)>& func) {
+  if (count == 0) {
+    return;
+  }
+  auto batch = std::make_shared<Batch>();
+  batch->count = count;
+  size_t helpers = std::min(workers_.size(), count - 1);
+  {
+    std::lock_guard lock(mutex_);
+    for (size_t i = 0; i < helpers; ++i) {
+      jobs_.emplace_back([batch, &func] { Drain(*batch, func); });
+    }
+  }
+  if (helpers == 1) {
+    wake_.notify_one();
+  } else if (helpers > 1) {
+    wake_.notify_all();
+  }
+  bool was_parallel = std::exchange(in_parallel_, true);
+  Drain(*batch, func);
+  in_parallel_ = was_parallel;
+  std::unique_lock lock(batch->mutex);
+  batch->finished.wait(lock, [&] { return batch->done == batch->count; });
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+}
+
+inline void MatrixThreadPool::WorkerLoop() {
+  in_parallel_ = true;
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+struct MatrixKernels {
+  static constexpr size_t kBlockRows = 96;
+  static constexpr size_t kBlockDepth = 256;
+  static constexpr size_t kBlockCols = 2048;
+  static constexpr size_t kTileRows = 4;
+  static constexpr size_t kStrassenLeaf = 1024;
+  static constexpr size_t kStrassenFloatDepth = 2;
+  static constexpr size_t kTransposeLeaf = 32;
+  static constexpr size_t kUnrollLimit = 8;
+
+  template <typename T>
+  static constexpr size_t kTileCols = std::max<size_t>(4, 64 / sizeof(T));
+
+#if defined(__AVX2__)
+  static constexpr bool kWideIntegerVectors = true;
+#else
+  static constexpr bool kWideIntegerVectors = false;
+#endif
+
+  template <typename T>
+  static constexpr size_t kSmallGemm =
+      std::is_integral_v<T> && sizeof(T) > 4 && !kWideIntegerVectors
+          ? size_t(1024) * 1024 * 1024
+          : 16 * 16 * 16;
+
+  template <typename T>
+  static void Gemm(size_t rows, size_t cols, size_t depth, T alpha, const T* a,
+                   size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+                   bool transpose_b = false);
+
+  template <typename T>
+  static void GemmParallel(MatrixThreadPool& pool, size_t rows, size_t cols,
+                           size_t depth, T alpha, const T* a, size_t lda,
+                           const T* b, size_t ldb, T* c, size_t ldc,
+                           bool transpose_b = false);
+
+  template <typename T>
+  static constexpr void GemmSmall(size_t rows, size_t cols, size_t depth,
+                                  T alpha, const T* a, size_t lda, const T* b,
+                                  size_t ldb, T* c, size_t ldc,
+                                  bool transpose_b = false);
+
+  template <size_t N, size_t M, size_t K, typename T>
+  static constexpr void MultiplyUnrolled(const T* a, const T* b, T* c);
+
+  template <typename T>
+  static void Transpose(size_t rows, size_t cols, const T* src, size_t lds,
+                        T* dst, size_t ldd);
+
+  template <typename T>
+  static constexpr size_t kStrassenDepth =
+      std::is_floating_point_v<T> ? kStrassenFloatDepth
+                                  : std::numeric_limits<size_t>::max();
+
+  template <typename T, typename Leaf>
+  static void Strassen(size_t size, const T* a, size_t lda, const T* b,
+                       size_t ldb, T* c, size_t ldc, size_t depth, Leaf& leaf);
+
+  template <bool kMayParallelize = true, typename T>
+  static void Multiply(size_t rows, size_t cols, size_t depth, const T* a,
+                       size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+                       bool transpose_b = false);
+
+  template <bool kMayParallelize = true, typename T>
+  static void MultiplySquare(size_t size, const T* a, size_t lda, const T* b,
+                             size_t ldb, T* c, size_t ldc);
+
+ private:
+  template <size_t M, size_t K, typename T, size_t... kDepth>
+  static constexpr T DotUnrolled(const T* a, const T* b,
+                                 std::index_sequence<kDepth...> /*depth*/);
+
+  template <size_t N, size_t M, size_t K, typename T, size_t... kOut>
+  static constexpr void MultiplyUnrolled(const T* a, const T* b, T* c,
+                                         std::index_sequence<kOut...> /*out*/);
+
+  template <typename T>
+  static void TransposeTile(size_t rows, size_t cols, const T* src, size_t lds,
+                            T* dst, size_t ldd);
+
+  template <typename T>
+  static void Transpose4x4(const T* src, size_t lds, T* dst, size_t ldd);
+
+#if defined(__SSE__)
+  static void Transpose4x4(const float* src, size_t lds, float* dst,
+                           size_t ldd);
+#endif
+#if defined(__AVX__)
+  static void Transpose4x4(const double* src, size_t lds, double* dst,
+                           size_t ldd);
+#endif
+
+  template <typename T, typename Op>
+  static void Combine(size_t size, const T* a, size_t lda, const T* b,
+                      size_t ldb, T* c, size_t ldc, Op op);
+
+  template <typename T>
+  static T* Scratch(MatrixBuffer<T>& buffer, size_t size);
+
+  template <typename T>
+  static void PackA(size_t rows, size_t depth, const T* a, size_t lda, T* dst);
+
+  template <typename T>
+  static void PackB(size_t depth, size_t cols, const T* b, size_t ldb,
+                    bool transpose_b, T* dst);
+
+  template <typename T>
+  static void MicroKernel(size_t depth, const T* a, const T* b, T* tile);
+
+#if defined(__AVX2__) && defined(__FMA__)
+  static void MicroKernel(size_t depth, const double* a, const double* b,
+                          double* tile);
+  static void MicroKernel(size_t depth, const float* a, const float* b,
+                          float* tile);
+#endif
+
+  template <typename T>
+  static void StoreTile(size_t rows, size_t cols, T alpha, const T* tile, T* c,
+                        size_t ldc);
+};
+
+template <typename T>
+void MatrixKernels::Gemm(size_t rows, size_t cols, size_t depth, T alpha,
+                         const T* a, size_t lda, const T* b, size_t ldb, T* c,
+                         size_t ldc, bool transpose_b) {
+  if (rows * cols * depth <= kSmallGemm<T>) {
+    GemmSmall(rows, cols, depth, alpha, a, lda, b, ldb, c, ldc, transpose_b);
+    return;
+  }
+  constexpr size_t kCols = kTileCols<T>;
+  thread_local MatrixBuffer<T> packed_a;
+  thread_local MatrixBuffer<T> packed_b;
+  size_t block_depth = std::min(kBlockDepth, depth);
+  size_t block_rows =
+      (std::min(kBlockRows, rows) + kTileRows - 1) / kTileRows * kTileRows;
+  size_t block_cols = (std::min(kBlockCols, cols) + kCols - 1) / kCols * kCols;
+  T* a_pack = Scratch(packed_a, block_rows * block_depth);
+  T* b_pack = Scratch(packed_b, block_depth * block_cols);
+  alignas(kMatrixAlignment) T tile[kTileRows * kCols];
+  for (size_t jc = 0; jc < cols; jc += kBlockCols) {
+    size_t nc = std::min(kBlockCols, cols - jc);
+    for (size_t pc = 0; pc < depth; pc += kBlockDepth) {
+      size_t kc = std::min(kBlockDepth, depth - pc);
+      const T* b_block = transpose_b ? b + jc * ldb + pc : b + pc * ldb + jc;
+      PackB(kc, nc, b_block, ldb, transpose_b, b_pack);
+      for (size_t ic = 0; ic < rows; ic += kBlockRows) {
+        size_t mc = std::min(kBlockRows, rows - ic);
+        PackA(mc, kc, a + ic * lda + pc, lda, a_pack);
+        for (size_t jr = 0; jr < nc; jr += kCols) {
+          for (size_t ir = 0; ir < mc; ir += kTileRows) {
+            MicroKernel(kc, a_pack + ir * kc, b_pack + jr * kc, tile);
+            StoreTile(std::min(kTileRows, mc - ir), std::min(kCols, nc - jr),
+                      alpha, tile, c + (ic + ir) * ldc + jc + jr, ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void MatrixKernels::GemmParallel(MatrixThreadPool& pool, size_t rows,
+                                 size_t cols, size_t depth, T alpha,
+                                 const T* a, size_t lda, const T* b,
+                                 size_t ldb, T* c, size_t ldc,
+                                 bool transpose_b) {
+  constexpr size_t kCols = kTileCols<T>;
+  size_t threads = pool.Concurrency();
+  size_t row_tiles = (rows + kTileRows - 1) / kTileRows;
+  size_t col_tiles = (cols + kCols - 1) / kCols;
+  size_t row_parts = std::min(threads, row_tiles);
+  size_t col_parts =
+      std::min((threads + row_parts - 1) / row_parts, col_tiles);
+  size_t row_step = (row_tiles + row_parts - 1) / row_parts * kTileRows;
+  size_t col_step = (col_tiles + col_parts - 1) / col_parts * kCols;
+  pool.ParallelFor(row_parts * col_parts, [&](size_t part) {
+    size_t row = part / col_parts * row_step;
+    size_t col = part % col_parts * col_step;
+    if (row >= rows || col >= cols) {
+      return;
+    }
+    const T* b_slice = transpose_b ? b + col * ldb : b + col;
+    Gemm(std::min(row_step, rows - row), std::min(col_step, cols - col), depth,
+         alpha, a + row * lda, lda, b_slice, ldb, c + row * ldc + col, ldc,
+         transpose_b);
+  });
+}
+
+template <typename T, typename Op>
+void MatrixKernels::Combine(size_t size, const T* a, size_t lda, const T* b,
+                            size_t ldb, T* c, size_t ldc, Op op) {
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      c[i * ldc + j] = op(a[i * lda + j], b[i * ldb + j]);
+    }
+  }
+}
+
+template <typename T, typename Leaf>
+void MatrixKernels::Strassen(size_t size, const T* a, size_t lda, const T* b,
+                             size_t ldb, T* c, size_t ldc, size_t depth,
+                             Leaf& leaf) {
+  if (size % 2 != 0 || size <= kStrassenLeaf || depth == 0) {
+    for (size_t i = 0; i < size; ++i) {
+      std::fill_n(c + i * ldc, size, T());
+    }
+    leaf(size, a, lda, b, ldb, c, ldc);
+    return;
+  }
+  size_t half = size / 2;
+  const T* a11 = a;
+  const T* a12 = a + half;
+  const T* a21 = a + half * lda;
+  const T* a22 = a21 + half;
+  const T* b11 = b;
+  const T* b12 = b + half;
+  const T* b21 = b + half * ldb;
+  const T* b22 = b21 + half;
+  T* c11 = c;
+  T* c12 = c + half;
+  T* c21 = c + half * ldc;
+  T* c22 = c21 + half;
+  std::vector<T> x_buf(half * half);
+  std::vector<T> y_buf(half * half);
+  T* x = x_buf.data();
+  T* y = y_buf.data();
+  std::plus<> add;
+  std::minus<> sub;
+
+  Combine(half, a11, lda, a21, lda, x, half, sub);
+  Combine(half, b22, ldb, b12, ldb, y, half, sub);
+  Strassen(half, x, half, y, half, c21, ldc, depth - 1, leaf);
+  Combine(half, a21, lda, a22, lda, x, half, add);
+  Combine(half, b12, ldb, b11, ldb, y, half, sub);
+  Strassen(half, x, half, y, half, c22, ldc, depth - 1, leaf);
+  Combine(half, x, half, a11, lda, x, half, sub);
+  Combine(half, b22, ldb, y, half, y, half, sub);
+  Strassen(half, x, half, y, half, c12, ldc, depth - 1, leaf);
+  Combine(half, a12, lda, x, half, x, half, sub);
+  Strassen(half, x, half, b22, ldb, c11, ldc, depth - 1, leaf);
+  Strassen(half, a11, lda, b11, ldb, x, half, depth - 1, leaf);
+  Combine(half, x, half, c12, ldc, c12, ldc, add);
+  Combine(half, c12, ldc, c21, ldc, c21, ldc, add);
+  Combine(half, c12, ldc, c22, ldc, c12, ldc, add);
+  Combine(half, c21, ldc, c22, ldc, c22, ldc, add);
+  Combine(half, c12, ldc, c11, ldc, c12, ldc, add);
+  Combine(half, y, half, b21, ldb, y, half, sub);
+  Strassen(half, a22, lda, y, half, c11, ldc, depth - 1, leaf);
+  Combine(half, c21, ldc, c11, ldc, c21, ldc, sub);
+  Strassen(half, a12, lda, b21, ldb, c11, ldc, depth - 1, leaf);
+  Combine(half, x, half, c11, ldc, c11, ldc, add);
+}
+
+template <bool kMayParallelize, typename T>
+void MatrixKernels::Multiply(size_t rows, size_t cols, size_t depth,
+                             const T* a, size_t lda, const T* b, size_t ldb,
+                             T* c, size_t ldc, bool transpose_b) {
+  if constexpr (kMayParallelize) {
+    if (MatrixThreadPool::ShouldParallelize(rows * cols * depth)) {
+      GemmParallel(MatrixThreadPool::Instance(), rows, cols, depth, T(1), a,
+                   lda, b, ldb, c, ldc, transpose_b);
+      return;
+    }
+  }
+  Gemm(rows, cols, depth, T(1), a, lda, b, ldb, c, ldc, transpose_b);
+}
+
+template <bool kMayParallelize, typename T>
+void MatrixKernels::MultiplySquare(size_t size, const T* a, size_t lda,
+                                   const T* b, size_t ldb, T* c, size_t ldc) {
+  auto leaf = [](size_t leaf_size, const T* leaf_a, size_t leaf_lda,
+                 const T* leaf_b, size_t leaf_ldb, T* leaf_c,
+                 size_t leaf_ldc) {
+    Multiply<kMayParallelize>(leaf_size, leaf_size, leaf_size, leaf_a,
+                              leaf_lda, leaf_b, leaf_ldb, leaf_c, leaf_ldc);
+  };
+  Strassen(size, a, lda, b, ldb, c, ldc, kStrassenDepth<T>, leaf);
+}
+
+template <typename T>
+void MatrixKernels::Transpose(size_t rows, size_t cols, const T* src,
+                              size_t lds, T* dst, size_t ldd) {
+  if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+    TransposeTile(rows, cols, src, lds, dst, ldd);
+  } else if (rows >= cols) {
+    size_t half = rows / 2;
+    Transpose(half, cols, src, lds, dst, ldd);
+    Transpose(rows - half, cols, src + half * lds, lds, dst + half, ldd);
+  } else {
+    size_t half = cols / 2;
+    Transpose(rows, half, src, lds, dst, ldd);
+    Transpose(rows, cols - half, src + half, lds, dst + half * ldd, ldd);
+  }
+}
+
+template <typename T>
+void MatrixKernels::TransposeTile(size_t rows, size_t cols, const T* src,
+                                  size_t lds, T* dst, size_t ldd) {
+  size_t full_rows = rows / 4 * 4;
+  size_t full_cols = cols / 4 * 4;
+  for (size_t i = 0; i < full_rows; i += 4) {
+    for (size_t j = 0; j < full_cols; j += 4) {
+      Transpose4x4(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+    }
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = i < full_rows ? full_cols : 0; j < cols; ++j) {
+      dst[j * ldd + i] = src[i * lds + j];
+    }
+  }
+}
+
+template <typename T>
+void MatrixKernels::Transpose4x4(const T* src, size_t lds, T* dst,
+                                 size_t ldd) {
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      dst[j * ldd + i] = src[i * lds + j];
+    }
+  }
+}
+
+#if defined(__SSE__)
+inline void MatrixKernels::Transpose4x4(const float* src, size_t lds,
+                                        float* dst, size_t ldd) {
+  __m128 row0 = _mm_loadu_ps(src);
+  __m128 row1 = _mm_loadu_ps(src + lds);
+  __m128 row2 = _mm_loadu_ps(src + 2 * lds);
+  __m128 row3 = _mm_loadu_ps(src + 3 * lds);
+  _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+  _mm_storeu_ps(dst, row0);
+  _mm_storeu_ps(dst + ldd, row1);
+  _mm_storeu_ps(dst + 2 * ldd, row2);
+  _mm_storeu_ps(dst + 3 * ldd, row3);
+}
+#endif
+
+#if defined(__AVX__)
+inline void MatrixKernels::Transpose4x4(const double* src, size_t lds,
+                                        double* dst, size_t ldd) {
+  __m256d row0 = _mm256_loadu_pd(src);
+  __m256d row1 = _mm256_loadu_pd(src + lds);
+  __m256d row2 = _mm256_loadu_pd(src + 2 * lds);
+  __m256d row3 = _mm256_loadu_pd(src + 3 * lds);
+  __m256d low01 = _mm256_unpacklo_pd(row0, row1);
+  __m256d high01 = _mm256_unpackhi_pd(row0, row1);
+  __m256d low23 = _mm256_unpacklo_pd(row2, row3);
+  __m256d high23 = _mm256_unpackhi_pd(row2, row3);
+  _mm256_storeu_pd(dst, _mm256_permute2f128_pd(low01, low23, 0x20));
+  _mm256_storeu_pd(dst + ldd, _mm256_permute2f128_pd(high01, high23, 0x20));
+  _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(low01, low23, 0x31));
+  _mm256_storeu_pd(dst + 3 * ldd,
+                   _mm256_permute2f128_pd(high01, high23, 0x31));
+}
+#endif
+
+template <size_t M, size_t K, typename T, size_t... kDepth>
+constexpr T MatrixKernels::DotUnrolled(
+    const T* a, const T* b, std::index_sequence<kDepth...> /*depth*/) {
+  return ((a[kDepth] * b[kDepth * K]) + ...);
+}
+
+template <size_t N, size_t M, size_t K, typename T, size_t... kOut>
+constexpr void MatrixKernels::MultiplyUnrolled(
+    const T* a, const T* b, T* c, std::index_sequence<kOut...> /*out*/) {
+  ((c[kOut] = DotUnrolled<M, K>(a + kOut / K * M, b + kOut % K,
+                                std::make_index_sequence<M>())),
+   ...);
+}
+
+template <size_t N, size_t M, size_t K, typename T>
+constexpr void MatrixKernels::MultiplyUnrolled(const T* a, const T* b, T* c) {
+  static_assert(M > 0);
+  MultiplyUnrolled<N, M, K>(a, b, c, std::make_index_sequence<N * K>());
+}
+
+template <typename T>
+constexpr void MatrixKernels::GemmSmall(size_t rows, size_t cols, size_t depth,
+                                        T alpha, const T* a, size_t lda,
+                                        const T* b, size_t ldb, T* c,
+                                        size_t ldc, bool transpose_b) {
+  if (transpose_b) {
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t j = 0; j < cols; ++j) {
+        T sum{};
+        for (size_t k = 0; k < depth; ++k) {
+          sum += a[i * lda + k] * b[j * ldb + k];
+        }
+        c[i * ldc + j] += alpha * sum;
+      }
+    }
+    return;
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    T* c_row = c + i * ldc;
+    for (size_t k = 0; k < depth; ++k) {
+      T scaled = alpha * a[i * lda + k];
+      const T* b_row = b + k * ldb;
+      for (size_t j = 0; j < cols; ++j) {
+        c_row[j] += scaled * b_row[j];
+      }
+    }
+  }
+}
+
+template <typename T>
+T* MatrixKernels::Scratch(MatrixBuffer<T>& buffer, size_t size) {
+  if (buffer.size() < size) {
+    MatrixBuffer<T>(size).swap(buffer);
+  }
+  return buffer.data();
+}
+
+template <typename T>
+void MatrixKernels::PackA(size_t rows, size_t depth, const T* a, size_t lda,
+                          T* dst) {
+  for (size_t ir = 0; ir < rows; ir += kTileRows) {
+    size_t mr = std::min(kTileRows, rows - ir);
+    for (size_t p = 0; p < depth; ++p) {
+      for (size_t i = 0; i < kTileRows; ++i) {
+        *dst++ = i < mr ? a[(ir + i) * lda + p] : T();
+      }
+    }
+  }
+}
+
+template <typename T>
+void MatrixKernels::PackB(size_t depth, size_t cols, const T* b, size_t ldb,
+                          bool transpose_b, T* dst) {
+  constexpr size_t kCols = kTileCols<T>;
+  for (size_t jr = 0; jr < cols; jr += kCols) {
+    size_t nr = std::min(kCols, cols - jr);
+    if (transpose_b) {
+      for (size_t j = 0; j < kCols; ++j) {
+        const T* src = b + (jr + j) * ldb;
+        for (size_t p = 0; p < depth; ++p) {
+          dst[p * kCols + j] = j < nr ? src[p] : T();
+        }
+      }
+      dst += depth * kCols;
+      continue;
+    }
+    for (size_t p = 0; p < depth; ++p) {
+      const T* src = b + p * ldb + jr;
+      for (size_t j = 0; j < kCols; ++j) {
+        *dst++ = j < nr ? src[j] : T();
+      }
+    }
+  }
+}
+
+template <typename T>
+void MatrixKernels::MicroKernel(size_t depth, const T* a, const T* b,
+                                T* tile) {
+  constexpr size_t kCols = kTileCols<T>;
+  T acc[kTileRows][kCols] = {};
+  for (size_t p = 0; p < depth; ++p) {
+    for (size_t i = 0; i < kTileRows; ++i) {
+      T elem = a[p * kTileRows + i];
+      for (size_t j = 0; j < kCols; ++j) {
+        acc[i][j] += elem * b[p * kCols + j];
+      }
+    }
+  }
+  for (size_t i = 0; i < kTileRows; ++i) {
+    std::copy_n(acc[i], kCols, tile + i * kCols);
+  }
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+inline void MatrixKernels::MicroKernel(size_t depth, const double* a,
+                                       const double* b, double* tile) {
+  __m256d acc[kTileRows][2];
+  for (size_t i = 0; i < kTileRows; ++i) {
+    acc[i][0] = _mm256_setzero_pd();
+    acc[i][1] = _mm256_setzero_pd();
+  }
+  for (size_t p = 0; p < depth; ++p, a += kTileRows, b += 8) {
+    __m256d b0 = _mm256_loadu_pd(b);
+    __m256d b1 = _mm256_loadu_pd(b + 4);
+    for (size_t i = 0; i < kTileRows; ++i) {
+      __m256d elem = _mm256_broadcast_sd(a + i);
+      acc[i][0] = _mm256_fmadd_pd(elem, b0, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_pd(elem, b1, acc[i][1]);
+    }
+  }
+  for (size_t i = 0; i < kTileRows; ++i) {
+    _mm256_store_pd(tile + i * 8, acc[i][0]);
+    _mm256_store_pd(tile + i * 8 + 4, acc[i][1]);
+  }
+}
+
+inline void MatrixKernels::MicroKernel(size_t depth, const float* a,
+                                       const float* b, float* tile) {
+  __m256 acc[kTileRows][2];
+  for (size_t i = 0; i < kTileRows; ++i) {
+    acc[i][0] = _mm256_setzero_ps();
+    acc[i][1] = _mm256_setzero_ps();
+  }
+  for (size_t p = 0; p < depth; ++p, a += kTileRows, b += 16) {
+    __m256 b0 = _mm256_loadu_ps(b);
+    __m256 b1 = _mm256_loadu_ps(b + 8);
+    for (size_t i = 0; i < kTileRows; ++i) {
+      __m256 elem = _mm256_broadcast_ss(a + i);
+      acc[i][0] = _mm256_fmadd_ps(elem, b0, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(elem, b1, acc[i][1]);
+    }
+  }
+  for (size_t i = 0; i < kTileRows; ++i) {
+    _mm256_store_ps(tile + i * 16, acc[i][0]);
+    _mm256_store_ps(tile + i * 16 + 8, acc[i][1]);
+  }
+}
+#endif
+
+template <typename T>
+void MatrixKernels::StoreTile(size_t rows, size_t cols, T alpha, const T* tile,
+                              T* c, size_t ldc) {
+  constexpr size_t kCols = kTileCols<T>;
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      c[i * ldc + j] += alpha * tile[i * kCols + j];
+    }
+  }
+}
+
+struct MatrixSolvers {
+  static constexpr size_t kLuBlock = 64;
+  static constexpr size_t kQrBlock = 32;
+
+  template <typename T>
+  static bool LuFactor(size_t size, T* a, size_t lda, size_t* pivots);
+
+  template <typename T>
+  static void LuSolve(size_t size, const T* lu, size_t lda,
+                      const size_t* pivots, T* b, size_t ldb, size_t nrhs);
+
+  template <typename T>
+  static void QrFactor(size_t rows, size_t cols, T* a, size_t lda, T* tau);
+
+  template <typename T>
+  static T BareissDeterminant(size_t size, T* a, size_t lda);
+
+ private:
+  template <typename T>
+  static void Update(size_t rows, size_t cols, size_t depth, const T* a,
+                     size_t lda, const T* b, size_t ldb, T* c, size_t ldc);
+
+  template <typename T>
+  static void QrPanel(size_t rows, size_t cols, T* a, size_t lda, T* tau);
+};
+
+template <typename T>
+void MatrixSolvers::Update(size_t rows, size_t cols, size_t depth, const T* a,
+                           size_t lda, const T* b, size_t ldb, T* c,
+                           size_t ldc) {
+  if (MatrixThreadPool::ShouldParallelize(rows * cols * depth)) {
+    MatrixKernels::GemmParallel(MatrixThreadPool::Instance(), rows, cols,
+                                depth, T(-1), a, lda, b, ldb, c, ldc);
+  } else {
+    MatrixKernels::Gemm(rows, cols, depth, T(-1), a, lda, b, ldb, c, ldc);
+  }
+}
+
+template <typename T>
+bool MatrixSolvers::LuFactor(size_t size, T* a, size_t lda, size_t* pivots) {
+  for (size_t k0 = 0; k0 < size; k0 += kLuBlock) {
+    size_t k1 = std::min(size, k0 + kLuBlock);
+    for (size_t k = k0; k < k1; ++k) {
+      size_t pivot = k;
+      for (size_t i = k + 1; i < size; ++i) {
+        if (std::abs(a[i * lda + k]) > std::abs(a[pivot * lda + k])) {
+          pivot = i;
+        }
+      }
+      if (a[pivot * lda + k] == T()) {
+        return false;
+      }
+      pivots[k] = pivot;
+      if (pivot != k) {
+        std::swap_ranges(a + k * lda, a + k * lda + size, a + pivot * lda);
+      }
+      T inv = T(1) / a[k * lda + k];
+      for (size_t i = k + 1; i < size; ++i) {
+        T* row = a + i * lda;
+        row[k] *= inv;
+        for (size_t j = k + 1; j < k1; ++j) {
+          row[j] -= row[k] * a[k * lda + j];
+        }
+      }
+    }
+    if (k1 == size) {
+      break;
+    }
+    for (size_t k = k0; k < k1; ++k) {
+      for (size_t i = k + 1; i < k1; ++i) {
+        T factor = a[i * lda + k];
+        for (size_t j = k1; j < size; ++j) {
+          a[i * lda + j] -= factor * a[k * lda + j];
+        }
+      }
+    }
+    Update(size - k1, size - k1, k1 - k0, a + k1 * lda + k0, lda,
+           a + k0 * lda + k1, lda, a + k1 * lda + k1, lda);
+  }
+  return true;
+}
+
+template <typename T>
+void MatrixSolvers::LuSolve(size_t size, const T* lu, size_t lda,
+                            const size_t* pivots, T* b, size_t ldb,
+                            size_t nrhs) {
+  for (size_t k = 0; k < size; ++k) {
+    if (pivots[k] != k) {
+      std::swap_ranges(b + k * ldb, b + k * ldb + nrhs, b + pivots[k] * ldb);
+    }
+  }
+  for (size_t i0 = 0; i0 < size; i0 += kLuBlock) {
+    size_t i1 = std::min(size, i0 + kLuBlock);
+    if (i0 > 0) {
+      Update(i1 - i0, nrhs, i0, lu + i0 * lda, lda, b, ldb, b + i0 * ldb, ldb);
+    }
+    for (size_t i = i0; i < i1; ++i) {
+      for (size_t k = i0; k < i; ++k) {
+        T factor = lu[i * lda + k];
+        for (size_t j = 0; j < nrhs; ++j) {
+          b[i * ldb + j] -= factor * b[k * ldb + j];
+        }
+      }
+    }
+  }
+  size_t blocks = (size + kLuBlock - 1) / kLuBlock;
+  for (size_t block = blocks; block-- > 0;) {
+    size_t i0 = block * kLuBlock;
+    size_t i1 = std::min(size, i0 + kLuBlock);
+    if (i1 < size) {
+      Update(i1 - i0, nrhs, size - i1, lu + i0 * lda + i1, lda, b + i1 * ldb,
+             ldb, b + i0 * ldb, ldb);
+    }
+    for (size_t i = i1; i-- > i0;) {
+      for (size_t k = i + 1; k < i1; ++k) {
+        T factor = lu[i * lda + k];
+        for (size_t j = 0; j < nrhs; ++j) {
+          b[i * ldb + j] -= factor * b[k * ldb + j];
+        }
+      }
+      T inv = T(1) / lu[i * lda + i];
+      for (size_t j = 0; j < nrhs; ++j) {
+        b[i * ldb + j] *= inv;
+      }
+    }
+  }
+}
+
+template <typename T>
+void MatrixSolvers::QrFactor(size_t rows, size_t cols, T* a, size_t lda,
+                             T* tau) {
+  size_t steps = std::min(rows, cols);
+  std::vector<T> v;
+  std::vector<T> v_t;
+  std::vector<T> t;
+  std::vector<T> t_t;
+  std::vector<T> w;
+  std::vector<T> w_t;
+  for (size_t j0 = 0; j0 < steps; j0 += kQrBlock) {
+    size_t width = std::min(kQrBlock, steps - j0);
+    size_t height = rows - j0;
+    T* panel = a + j0 * lda + j0;
+    QrPanel(height, width, panel, lda, tau + j0);
+    size_t rest = cols - j0 - width;
+    if (rest == 0) {
+      continue;
+    }
+    v.assign(height * width, T());
+    for (size_t i = 0; i < height; ++i) {
+      for (size_t c = 0; c < width && c <= i; ++c) {
+        v[i * width + c] = i == c ? T(1) : panel[i * lda + c];
+      }
+    }
+    v_t.resize(width * height);
+    MatrixKernels::Transpose(height, width, v.data(), width, v_t.data(),
+                             height);
+    t.assign(width * width, T());
+    for (size_t i = 0; i < width; ++i) {
+      const T* v_i = v_t.data() + i * height;
+      for (size_t c = 0; c < i; ++c) {
+        const T* v_c = v_t.data() + c * height;
+        T dot{};
+        for (size_t p = i; p < height; ++p) {
+          dot += v_c[p] * v_i[p];
+        }
+        t[c * width + i] = dot;
+      }
+      for (size_t r = 0; r < i; ++r) {
+        T sum{};
+        for (size_t c = r; c < i; ++c) {
+          sum += t[r * width + c] * t[c * width + i];
+        }
+        t[r * width + i] = sum;
+      }
+      for (size_t r = 0; r < i; ++r) {
+        t[r * width + i] *= -tau[j0 + i];
+      }
+      t[i * width + i] = tau[j0 + i];
+    }
+    t_t.resize(width * width);
+    MatrixKernels::Transpose(width, width, t.data(), width, t_t.data(), width);
+    T* trailing = panel + width;
+    w.assign(width * rest, T());
+    MatrixKernels::Multiply(width, rest, height, v_t.data(), height, trailing,
+                            lda, w.data(), rest);
+    w_t.assign(width * rest, T());
+    MatrixKernels::Multiply(width, rest, width, t_t.data(), width, w.data(),
+                            rest, w_t.data(), rest);
+    Update(height, rest, width, v.data(), width, w_t.data(), rest, trailing,
+           lda);
+  }
+}
+
+template <typename T>
+void MatrixSolvers::QrPanel(size_t rows, size_t cols, T* a, size_t lda,
+                            T* tau) {
+  std::vector<T> w(cols);
+  for (size_t j = 0; j < std::min(rows, cols); ++j) {
+    T norm{};
+    for (size_t i = j; i < rows; ++i) {
+      norm += a[i * lda + j] * a[i * lda + j];
+    }
+    norm = std::sqrt(norm);
+    if (norm == T()) {
+      tau[j] = T();
+      continue;
+    }
+    T alpha = a[j * lda + j];
+    T beta = -std::copysign(norm, alpha);
+    tau[j] = (beta - alpha) / beta;
+    T scale = T(1) / (alpha - beta);
+    for (size_t i = j + 1; i < rows; ++i) {
+      a[i * lda + j] *= scale;
+    }
+    a[j * lda + j] = beta;
+    std::copy(a + j * lda + j + 1, a + j * lda + cols, w.begin() + j + 1);
+    for (size_t i = j + 1; i < rows; ++i) {
+      T v = a[i * lda + j];
+      for (size_t c = j + 1; c < cols; ++c) {
+        w[c] += v * a[i * lda + c];
+      }
+    }
+    for (size_t c = j + 1; c < cols; ++c) {
+      a[j * lda + c] -= tau[j] * w[c];
+    }
+    for (size_t i = j + 1; i < rows; ++i) {
+      T v = tau[j] * a[i * lda + j];
+      for (size_t c = j + 1; c < cols; ++c) {
+        a[i * lda + c] -= v * w[c];
+      }
+    }
+  }
+}
+
+template <typename T>
+T MatrixSolvers::BareissDeterminant(size_t size, T* a, size_t lda) {
+  T sign = T(1);
+  T prev = T(1);
+  for (size_t k = 0; k + 1 < size; ++k) {
+    if (a[k * lda + k] == T()) {
+      size_t pivot = k + 1;
+      while (pivot < size && a[pivot * lda + k] == T()) {
+        ++pivot;
+      }
+      if (pivot == size) {
+        return T();
+      }
+      std::swap_ranges(a + k * lda + k, a + k * lda + size,
+                       a + pivot * lda + k);
+      sign = -sign;
+    }
+    for (size_t i = k + 1; i < size; ++i) {
+      for (size_t j = k + 1; j < size; ++j) {
+        a[i * lda + j] = (a[i * lda + j] * a[k * lda + k] -
+                          a[i * lda + k] * a[k * lda + j]) /
+                         prev;
+      }
+    }
+    prev = a[k * lda + k];
+  }
+  return size == 0 ? T(1) : sign * a[(size - 1) * lda + size - 1];
+}
+
 template <size_t N, size_t M, typename T = int64_t>
-class Matrix {
+class Matrix;
+
+template <typename E>
+struct MatrixOperand {
+  using type = E;
+};
+
+template <size_t N, size_t M, typename T>
+struct MatrixOperand<Matrix<N, M, T>> {
+  using type = const Matrix<N, M, T>&;
+};
+
+template <typename E>
+inline constexpr bool kIsMatrix = false;
+
+template <size_t N, size_t M, typename T>
+inline constexpr bool kIsMatrix<Matrix<N, M, T>> = true;
+
+template <typename Derived>
+class MatrixExpr {
  public:
-  Matrix();
-  Matrix(std::vector<std::vector<T>> vec);
-  Matrix(T elem);
-
-  Matrix& operator+=(const Matrix& obj);
-  Matrix operator+(const Matrix& obj) const;
-  Matrix& operator-=(const Matrix& obj);
-  Matrix operator-(const Matrix& obj) const;
-  Matrix& operator*=(T elem);
-  Matrix operator*(T elem) const;
-  Matrix<M, N, T> Transposed() const;
-  bool operator==(const Matrix& obj);
-  T& operator()(size_t i, size_t j);
-  const T& operator()(size_t i, size_t j) const;
+  constexpr const Derived& Self() const {
+    return static_cast<const Derived&>(*this);
+  }
 
-  template <size_t K>
-  Matrix<N, K, T> operator*(const Matrix<M, K, T>& obj) const;
+  constexpr auto Eval() const {
+    return Matrix<Derived::kRows, Derived::kCols,
+                  typename Derived::value_type>(*this);
+  }
+
+  constexpr auto Trace() const
+    requires(Derived::kRows == Derived::kCols)
+  {
+    typename Derived::value_type res{};
+    for (size_t i = 0; i < Derived::kRows; ++i) {
+      res += Self()(i, i);
+    }
+    return res;
+  }
+
+  constexpr auto Transposed() const { return Eval().Transposed(); }
+};
 
-  T Trace();
-  T TraceCounter(Matrix<N, N, T> obj);
+template <typename Lhs, typename Rhs, typename Op>
+class MatrixBinaryExpr : public MatrixExpr<MatrixBinaryExpr<Lhs, Rhs, Op>> {
+  static_assert(Lhs::kRows == Rhs::kRows && Lhs::kCols == Rhs::kCols,
+                "matrix dimensions must match");
+
+ public:
+  static constexpr size_t kRows = Lhs::kRows;
+  static constexpr size_t kCols = Lhs::kCols;
+  static constexpr bool kReordersElements =
+      Lhs::kReordersElements || Rhs::kReordersElements;
+  using value_type = typename Lhs::value_type;
+
+  constexpr MatrixBinaryExpr(const Lhs& lhs, const Rhs& rhs)
+      : lhs_(lhs), rhs_(rhs) {}
+
+  constexpr value_type At(size_t idx) const {
+    return Op()(lhs_.At(idx), rhs_.At(idx));
+  }
+
+  constexpr value_type operator()(size_t i, size_t j) const {
+    return At(i * kCols + j);
+  }
+
+ private:
+  typename MatrixOperand<Lhs>::type lhs_;
+  typename MatrixOperand<Rhs>::type rhs_;
+};
+
+template <typename E>
+class MatrixScaledExpr : public MatrixExpr<MatrixScaledExpr<E>> {
+ public:
+  static constexpr size_t kRows = E::kRows;
+  static constexpr size_t kCols = E::kCols;
+  static constexpr bool kReordersElements = E::kReordersElements;
+  using value_type = typename E::value_type;
+
+  constexpr MatrixScaledExpr(const E& expr, value_type scalar)
+      : expr_(expr), scalar_(scalar) {}
+
+  constexpr value_type At(size_t idx) const { return expr_.At(idx) * scalar_; }
+
+  constexpr value_type operator()(size_t i, size_t j) const {
+    return At(i * kCols + j);
+  }
 
  private:
-  std::vector<std::vector<T>> arr_;
+  typename MatrixOperand<E>::type expr_;
+  value_type scalar_;
 };
 
 template <size_t N, size_t M, typename T>
-T Matrix<N, M, T>::Trace() {
-  return TraceCounter(*this);
+class MatrixFillExpr : public MatrixExpr<MatrixFillExpr<N, M, T>> {
+ public:
+  static constexpr size_t kRows = N;
+  static constexpr size_t kCols = M;
+  static constexpr bool kReordersElements = false;
+  using value_type = T;
+
+  constexpr explicit MatrixFillExpr(T value) : value_(value) {}
+
+  constexpr T At(size_t) const { return value_; }
+
+  constexpr T operator()(size_t, size_t) const { return value_; }
+
+ private:
+  T value_;
+};
+
+template <typename E>
+class MatrixTransposeExpr : public MatrixExpr<MatrixTransposeExpr<E>> {
+ public:
+  static constexpr size_t kRows = E::kCols;
+  static constexpr size_t kCols = E::kRows;
+  static constexpr bool kReordersElements = true;
+  using value_type = typename E::value_type;
+
+  constexpr explicit MatrixTransposeExpr(const E& expr) : expr_(expr) {}
+
+  constexpr const E& Base() const { return expr_; }
+
+  constexpr value_type At(size_t idx) const {
+    return expr_.At(idx % kCols * kRows + idx / kCols);
+  }
+
+  constexpr value_type operator()(size_t i, size_t j) const {
+    return expr_(j, i);
+  }
+
+ private:
+  typename MatrixOperand<E>::type expr_;
+};
+
+template <typename Lhs, typename Rhs>
+constexpr MatrixBinaryExpr<Lhs, Rhs, std::plus<>> operator+(
+    const MatrixExpr<Lhs>& lhs, const MatrixExpr<Rhs>& rhs) {
+  return {lhs.Self(), rhs.Self()};
+}
+
+template <typename Lhs, typename Rhs>
+constexpr MatrixBinaryExpr<Lhs, Rhs, std::minus<>> operator-(
+    const MatrixExpr<Lhs>& lhs, const MatrixExpr<Rhs>& rhs) {
+  return {lhs.Self(), rhs.Self()};
+}
+
+template <typename Lhs, typename Rhs>
+  requires(!kIsMatrix<Lhs> && Lhs::kRows == Rhs::kRows &&
+           Lhs::kCols == Rhs::kCols)
+constexpr bool operator==(const MatrixExpr<Lhs>& lhs,
+                          const MatrixExpr<Rhs>& rhs) {
+  for (size_t i = 0; i < Lhs::kRows * Lhs::kCols; ++i) {
+    if (lhs.Self().At(i) != rhs.Self().At(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename E>
+using MatrixFillOf =
+    MatrixFillExpr<E::kRows, E::kCols, typename E::value_type>;
+
+template <typename E>
+constexpr MatrixBinaryExpr<E, MatrixFillOf<E>, std::plus<>> operator+(
+    const MatrixExpr<E>& expr, typename E::value_type scalar) {
+  return {expr.Self(), MatrixFillOf<E>(scalar)};
+}
+
+template <typename E>
+constexpr MatrixBinaryExpr<E, MatrixFillOf<E>, std::minus<>> operator-(
+    const MatrixExpr<E>& expr, typename E::value_type scalar) {
+  return {expr.Self(), MatrixFillOf<E>(scalar)};
+}
+
+template <typename E>
+constexpr MatrixScaledExpr<E> operator*(const MatrixExpr<E>& expr,
+                                        typename E::value_type scalar) {
+  return {expr.Self(), scalar};
+}
+
+template <typename Lhs, typename Rhs>
+  requires(!(kIsMatrix<Lhs> && kIsMatrix<Rhs>))
+constexpr auto operator*(const MatrixExpr<Lhs>& lhs,
+                         const MatrixExpr<Rhs>& rhs) {
+  const Matrix<Lhs::kRows, Lhs::kCols, typename Lhs::value_type>& left =
+      lhs.Self();
+  const Matrix<Rhs::kRows, Rhs::kCols, typename Rhs::value_type>& right =
+      rhs.Self();
+  return left * right;
+}
+
+template <size_t N, size_t M, size_t K, typename T>
+constexpr Matrix<N, K, T> operator*(
+    const Matrix<N, M, T>& lhs,
+    const MatrixTransposeExpr<Matrix<K, M, T>>& rhs) {
+  if (std::is_constant_evaluated() ||
+      std::max({N, M, K}) <= MatrixKernels::kUnrollLimit) {
+    return lhs * Matrix<M, K, T>(rhs);
+  }
+  Matrix<N, K, T> res;
+  MatrixKernels::Multiply<N * M * K >= MatrixThreadPool::kMinParallelWork>(
+      N, K, M, lhs.data(), M, rhs.Base().data(), M, res.data(), K, true);
+  return res;
 }
 
 template <size_t N, size_t M, typename T>
-T Matrix<N, M, T>::TraceCounter(Matrix<N, N, T> obj) {
-  T res;
+class Matrix : public MatrixExpr<Matrix<N, M, T>> {
+ public:
+  static constexpr size_t kRows = N;
+  static constexpr size_t kCols = M;
+  static constexpr bool kReordersElements = false;
+  using value_type = T;
+
+  constexpr Matrix();
+  constexpr Matrix(std::vector<std::vector<T>> vec);
+  constexpr Matrix(T elem);
+
+  template <typename E>
+  constexpr Matrix(const MatrixExpr<E>& expr);
+
+  template <typename E>
+  constexpr Matrix& operator=(const MatrixExpr<E>& expr);
+  template <typename E>
+  constexpr Matrix& operator+=(const MatrixExpr<E>& expr);
+  template <typename E>
+  constexpr Matrix& operator-=(const MatrixExpr<E>& expr);
+  constexpr Matrix& operator+=(T elem);
+  constexpr Matrix& operator-=(T elem);
+  constexpr Matrix& operator*=(T elem);
+  constexpr Matrix<M, N, T> Transposed() const;
+  constexpr MatrixTransposeExpr<Matrix> TransposedView() const&;
+  MatrixTransposeExpr<Matrix> TransposedView() const&& = delete;
+  template <typename E>
+  constexpr bool operator==(const MatrixExpr<E>& expr) const
+    requires(E::kRows == N && E::kCols == M);
+  constexpr T& operator()(size_t i, size_t j);
+  constexpr const T& operator()(size_t i, size_t j) const;
+  constexpr T At(size_t idx) const;
+
+  template <size_t K>
+  constexpr Matrix<N, K, T> operator*(const Matrix<M, K, T>& obj) const;
+
+  constexpr T Trace() const
+    requires(N == M);
+
+  T Determinant() const
+    requires(N == M);
+  Matrix Inverse() const
+    requires(N == M && std::is_floating_point_v<T>);
+  template <size_t K>
+  Matrix<N, K, T> Solve(const Matrix<N, K, T>& obj) const
+    requires(N == M && std::is_floating_point_v<T>);
+
+  std::vector<size_t> LuDecompose()
+    requires(N == M && std::is_floating_point_v<T>);
+  std::vector<T> QrDecompose()
+    requires(std::is_floating_point_v<T>);
+
+  constexpr T* data();
+  constexpr const T* data() const;
+
+ private:
+  template <typename Func>
+  static constexpr void ForEachChunk(Func func);
+
+  template <typename E, typename Op>
+  constexpr void Apply(const MatrixExpr<E>& expr, Op op);
+  template <typename E>
+  constexpr void Evaluate(const MatrixExpr<E>& expr);
+
+  MatrixStorage<T, N * M> arr_;
+};
+
+template <size_t N, size_t M, typename T>
+constexpr T Matrix<N, M, T>::Trace() const
+  requires(N == M)
+{
+  T res{};
   for (size_t i = 0; i < N; ++i) {
-    res += obj.arr_[i][i];
+    res += (*this)(i, i);
   }
   return res;
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>::Matrix() {
-  arr_.resize(N, std::vector<T>(M));
+constexpr Matrix<N, M, T>::Matrix() = default;
+
+template <size_t N, size_t M, typename T>
+constexpr Matrix<N, M, T>::Matrix(std::vector<std::vector<T>> vec) {
+  for (size_t i = 0; i < N; ++i) {
+    std::copy_n(vec[i].begin(), M, data() + i * M);
+  }
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>::Matrix(std::vector<std::vector<T>> vec) {
-  arr_ = vec;
+constexpr Matrix<N, M, T>::Matrix(T elem) {
+  std::fill_n(data(), N * M, elem);
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>::Matrix(T elem) {
-  arr_.resize(N, std::vector<T>(M));
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      arr_[i][j] = elem;
+constexpr T* Matrix<N, M, T>::data() {
+  return arr_.data();
+}
+
+template <size_t N, size_t M, typename T>
+constexpr const T* Matrix<N, M, T>::data() const {
+  return arr_.data();
+}
+
+template <size_t N, size_t M, typename T>
+template <typename Func>
+constexpr void Matrix<N, M, T>::ForEachChunk(Func func) {
+  if constexpr (N * M >= MatrixThreadPool::kMinParallelWork) {
+    if (!std::is_constant_evaluated()) {
+      MatrixThreadPool::ForEachChunk(N * M, func);
+      return;
     }
   }
+  func(0, N * M);
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>& Matrix<N, M, T>::operator+=(const Matrix<N, M, T>& obj) {
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      arr_[i][j] += obj.arr_[i][j];
-    }
+template <typename E, typename Op>
+constexpr void Matrix<N, M, T>::Apply(const MatrixExpr<E>& expr, Op op) {
+  static_assert(E::kRows == N && E::kCols == M,
+                "matrix dimensions must match");
+  if constexpr (E::kReordersElements) {
+    Matrix tmp;
+    tmp.Evaluate(expr);
+    Apply(tmp, op);
+    return;
   }
-  return *this;
+  T* dst = data();
+  const E& src = expr.Self();
+  ForEachChunk([dst, &src, op](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      op(dst[i], src.At(i));
+    }
+  });
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>& Matrix<N, M, T>::operator-=(const Matrix<N, M, T>& obj) {
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      arr_[i][j] -= obj.arr_[i][j];
+template <typename E>
+constexpr void Matrix<N, M, T>::Evaluate(const MatrixExpr<E>& expr) {
+  static_assert(E::kRows == N && E::kCols == M,
+                "matrix dimensions must match");
+  if constexpr (std::is_same_v<E, MatrixTransposeExpr<Matrix<M, N, T>>>) {
+    if (!std::is_constant_evaluated()) {
+      MatrixKernels::Transpose(M, N, expr.Self().Base().data(), N, data(), M);
+      return;
     }
   }
+  T* dst = data();
+  const E& src = expr.Self();
+  ForEachChunk([dst, &src](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      dst[i] = src.At(i);
+    }
+  });
+}
+
+template <size_t N, size_t M, typename T>
+template <typename E>
+constexpr Matrix<N, M, T>::Matrix(const MatrixExpr<E>& expr) {
+  Evaluate(expr);
+}
+
+template <size_t N, size_t M, typename T>
+template <typename E>
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator=(
+    const MatrixExpr<E>& expr) {
+  Apply(expr, [](T& dst, const T& src) { dst = src; });
   return *this;
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T> Matrix<N, M, T>::operator+(const Matrix<N, M, T>& obj) const {
-  Matrix<N, M, T> copy = *this;
-  copy += obj;
-  return copy;
+template <typename E>
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator+=(
+    const MatrixExpr<E>& expr) {
+  Apply(expr, [](T& dst, const T& src) { dst += src; });
+  return *this;
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T> Matrix<N, M, T>::operator-(const Matrix<N, M, T>& obj) const {
-  Matrix<N, M, T> copy = *this;
-  copy -= obj;
-  return copy;
+template <typename E>
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator-=(
+    const MatrixExpr<E>& expr) {
+  Apply(expr, [](T& dst, const T& src) { dst -= src; });
+  return *this;
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T>& Matrix<N, M, T>::operator*=(const T kElem) {
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      arr_[i][j] *= kElem;
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator+=(const T kElem) {
+  return *this += MatrixFillExpr<N, M, T>(kElem);
+}
+
+template <size_t N, size_t M, typename T>
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator-=(const T kElem) {
+  return *this -= MatrixFillExpr<N, M, T>(kElem);
+}
+
+template <size_t N, size_t M, typename T>
+constexpr Matrix<N, M, T>& Matrix<N, M, T>::operator*=(const T kElem) {
+  T* dst = data();
+  ForEachChunk([dst, kElem](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      dst[i] *= kElem;
     }
-  }
+  });
   return *this;
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<N, M, T> Matrix<N, M, T>::operator*(const T kElem) const {
-  Matrix<N, M, T> copy = *this;
-  copy *= kElem;
-  return copy;
+constexpr Matrix<M, N, T> Matrix<N, M, T>::Transposed() const {
+  return Matrix<M, N, T>(TransposedView());
 }
 
 template <size_t N, size_t M, typename T>
-Matrix<M, N, T> Matrix<N, M, T>::Transposed() const {
-  std::vector<std::vector<T>> vec(M, std::vector<T>(N));
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      vec[j][i] = arr_[i][j];
-    }
-  }
-  Matrix<M, N, T> newmatrix = vec;
-  return newmatrix;
+constexpr MatrixTransposeExpr<Matrix<N, M, T>>
+Matrix<N, M, T>::TransposedView() const& {
+  return MatrixTransposeExpr<Matrix>(*this);
 }
 
 template <size_t N, size_t M, typename T>
-bool Matrix<N, M, T>::operator==(const Matrix<N, M, T>& obj) {
-  for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < M; ++j) {
-      if (arr_[i][j] != obj.arr_[i][j]) {
+template <typename E>
+constexpr bool Matrix<N, M, T>::operator==(const MatrixExpr<E>& expr) const
+  requires(E::kRows == N && E::kCols == M)
+{
+  if constexpr (std::is_same_v<E, Matrix>) {
+    return std::equal(data(), data() + N * M, expr.Self().data());
+  } else {
+    for (size_t i = 0; i < N * M; ++i) {
+      if (data()[i] != expr.Self().At(i)) {
         return false;
       }
     }
+    return true;
   }
-  return true;
 }
 
 template <size_t N, size_t M, typename T>
-const T& Matrix<N, M, T>::operator()(const size_t kI, const size_t kJ) const {
-  return arr_[kI][kJ];
+constexpr const T& Matrix<N, M, T>::operator()(const size_t kI,
+                                               const size_t kJ) const {
+  return arr_.data()[kI * M + kJ];
+}
+
+template <size_t N, size_t M, typename T>
+constexpr T& Matrix<N, M, T>::operator()(const size_t kI,
+                                         const size_t kJ) {
+  return arr_.data()[kI * M + kJ];
 }
 
 template <size_t N, size_t M, typename T>
-T& Matrix<N, M, T>::operator()(const size_t kI, const size_t kJ) {
-  return arr_[kI][kJ];
+constexpr T Matrix<N, M, T>::At(const size_t kIdx) const {
+  return arr_.data()[kIdx];
 }
 
 template <size_t N, size_t M, typename T>
 template <size_t K>
-Matrix<N, K, T> Matrix<N, M, T>::operator*(const Matrix<M, K, T>& obj) const {
+constexpr Matrix<N, K, T> Matrix<N, M, T>::operator*(
+    const Matrix<M, K, T>& obj) const {
+  constexpr bool kMayParallelize =
+      N * M * K >= MatrixThreadPool::kMinParallelWork;
   Matrix<N, K, T> res;
+  if constexpr (M > 0 && std::max({N, M, K}) <= MatrixKernels::kUnrollLimit) {
+    MatrixKernels::MultiplyUnrolled<N, M, K>(data(), obj.data(), res.data());
+  } else {
+    if (std::is_constant_evaluated()) {
+      MatrixKernels::GemmSmall(N, K, M, T(1), data(), M, obj.data(), K,
+                               res.data(), K);
+    } else if constexpr (N == M && M == K && N % 2 == 0 &&
+                         N > MatrixKernels::kStrassenLeaf) {
+      MatrixKernels::MultiplySquare<kMayParallelize>(N, data(), M, obj.data(),
+                                                     K, res.data(), K);
+    } else {
+      MatrixKernels::Multiply<kMayParallelize>(N, K, M, data(), M, obj.data(),
+                                               K, res.data(), K);
+    }
+  }
+  return res;
+}
+
+template <size_t N, size_t M, typename T>
+std::vector<size_t> Matrix<N, M, T>::LuDecompose()
+  requires(N == M && std::is_floating_point_v<T>)
+{
+  std::vector<size_t> pivots(N);
+  if (!MatrixSolvers::LuFactor(N, data(), M, pivots.data())) {
+    throw std::domain_error("Matrix: singular matrix");
+  }
+  return pivots;
+}
+
+template <size_t N, size_t M, typename T>
+std::vector<T> Matrix<N, M, T>::QrDecompose()
+  requires(std::is_floating_point_v<T>)
+{
+  std::vector<T> tau(std::min(N, M));
+  MatrixSolvers::QrFactor(N, M, data(), M, tau.data());
+  return tau;
+}
+
+template <size_t N, size_t M, typename T>
+T Matrix<N, M, T>::Determinant() const
+  requires(N == M)
+{
+  Matrix copy = *this;
+  if constexpr (std::is_integral_v<T>) {
+    return MatrixSolvers::BareissDeterminant(N, copy.data(), M);
+  } else {
+    std::vector<size_t> pivots(N);
+    if (!MatrixSolvers::LuFactor(N, copy.data(), M, pivots.data())) {
+      return T();
+    }
+    T res = T(1);
+    for (size_t i = 0; i < N; ++i) {
+      res *= pivots[i] == i ? copy(i, i) : -copy(i, i);
+    }
+    return res;
+  }
+}
+
+template <size_t N, size_t M, typename T>
+Matrix<N, M, T> Matrix<N, M, T>::Inverse() const
+  requires(N == M && std::is_floating_point_v<T>)
+{
+  Matrix identity;
   for (size_t i = 0; i < N; ++i) {
-    for (size_t j = 0; j < K; ++j) {
-      for (size_t k = 0; k < M; ++k) {
-        res(i, j) += (*this)(i, k) * obj(k, j);
-      }
+    identity(i, i) = T(1);
+  }
+  return Solve(identity);
+}
+
+template <size_t N, size_t M, typename T>
+template <size_t K>
+Matrix<N, K, T> Matrix<N, M, T>::Solve(const Matrix<N, K, T>& obj) const
+  requires(N == M && std::is_floating_point_v<T>)
+{
+  Matrix copy = *this;
+  std::vector<size_t> pivots = copy.LuDecompose();
+  Matrix<N, K, T> res = obj;
+  MatrixSolvers::LuSolve(N, copy.data(), M, pivots.data(), res.data(), K, K);
+  return res;
+}
+
+template <typename T = int64_t>
+class DynamicMatrix {
+ public:
+  using value_type = T;
+
+  DynamicMatrix() = default;
+  DynamicMatrix(size_t rows, size_t cols, T elem = T());
+  DynamicMatrix(const std::vector<std::vector<T>>& vec);
+
+  template <size_t N, size_t M>
+  DynamicMatrix(const Matrix<N, M, T>& obj);
+
+  DynamicMatrix(const DynamicMatrix& other) = default;
+  DynamicMatrix(DynamicMatrix&& other) noexcept;
+  DynamicMatrix& operator=(const DynamicMatrix& other) = default;
+  DynamicMatrix& operator=(DynamicMatrix&& other) noexcept;
+
+  size_t Rows() const;
+  size_t Cols() const;
+
+  DynamicMatrix& operator+=(const DynamicMatrix& obj);
+  DynamicMatrix operator+(const DynamicMatrix& obj) const;
+  DynamicMatrix& operator-=(const DynamicMatrix& obj);
+  DynamicMatrix operator-(const DynamicMatrix& obj) const;
+  DynamicMatrix& operator*=(T elem);
+  DynamicMatrix operator*(T elem) const;
+  DynamicMatrix operator*(const DynamicMatrix& obj) const;
+  DynamicMatrix Transposed() const;
+  bool operator==(const DynamicMatrix& obj) const;
+  T& operator()(size_t i, size_t j);
+  const T& operator()(size_t i, size_t j) const;
+
+  T Trace() const;
+
+  T* data();
+  const T* data() const;
+
+ private:
+  void CheckSameShape(const DynamicMatrix& obj) const;
+
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  MatrixBuffer<T> arr_;
+};
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(size_t rows, size_t cols, T elem)
+    : rows_(rows), cols_(cols), arr_(rows * cols) {
+  std::fill_n(data(), rows_ * cols_, elem);
+}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(const std::vector<std::vector<T>>& vec)
+    : rows_(vec.size()),
+      cols_(vec.empty() ? 0 : vec[0].size()),
+      arr_(rows_ * cols_) {
+  for (size_t i = 0; i < rows_; ++i) {
+    if (vec[i].size() != cols_) {
+      throw std::invalid_argument("DynamicMatrix: rows of different length");
     }
+    std::copy_n(vec[i].begin(), cols_, data() + i * cols_);
+  }
+}
+
+template <typename T>
+template <size_t N, size_t M>
+DynamicMatrix<T>::DynamicMatrix(const Matrix<N, M, T>& obj)
+    : rows_(N), cols_(M), arr_(N * M) {
+  std::copy_n(obj.data(), N * M, data());
+}
+
+template <typename T>
+DynamicMatrix<T>::DynamicMatrix(DynamicMatrix&& other) noexcept
+    : rows_(std::exchange(other.rows_, 0)),
+      cols_(std::exchange(other.cols_, 0)),
+      arr_(std::move(other.arr_)) {}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator=(DynamicMatrix&& other) noexcept {
+  std::swap(rows_, other.rows_);
+  std::swap(cols_, other.cols_);
+  arr_.swap(other.arr_);
+  return *this;
+}
+
+template <typename T>
+size_t DynamicMatrix<T>::Rows() const {
+  return rows_;
+}
+
+template <typename T>
+size_t DynamicMatrix<T>::Cols() const {
+  return cols_;
+}
+
+template <typename T>
+T* DynamicMatrix<T>::data() {
+  return arr_.data();
+}
+
+template <typename T>
+const T* DynamicMatrix<T>::data() const {
+  return arr_.data();
+}
+
+template <typename T>
+void DynamicMatrix<T>::CheckSameShape(const DynamicMatrix& obj) const {
+  if (rows_ != obj.rows_ || cols_ != obj.cols_) {
+    throw std::invalid_argument("DynamicMatrix: dimension mismatch");
+  }
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator+=(const DynamicMatrix& obj) {
+  CheckSameShape(obj);
+  T* dst = data();
+  const T* src = obj.data();
+  MatrixThreadPool::ForEachChunk(rows_ * cols_,
+                                 [dst, src](size_t first, size_t last) {
+                                   for (size_t i = first; i < last; ++i) {
+                                     dst[i] += src[i];
+                                   }
+                                 });
+  return *this;
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator-=(const DynamicMatrix& obj) {
+  CheckSameShape(obj);
+  T* dst = data();
+  const T* src = obj.data();
+  MatrixThreadPool::ForEachChunk(rows_ * cols_,
+                                 [dst, src](size_t first, size_t last) {
+                                   for (size_t i = first; i < last; ++i) {
+                                     dst[i] -= src[i];
+                                   }
+                                 });
+  return *this;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::operator+(const DynamicMatrix& obj) const {
+  DynamicMatrix copy = *this;
+  copy += obj;
+  return copy;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::operator-(const DynamicMatrix& obj) const {
+  DynamicMatrix copy = *this;
+  copy -= obj;
+  return copy;
+}
+
+template <typename T>
+DynamicMatrix<T>& DynamicMatrix<T>::operator*=(const T kElem) {
+  T* dst = data();
+  MatrixThreadPool::ForEachChunk(rows_ * cols_,
+                                 [dst, kElem](size_t first, size_t last) {
+                                   for (size_t i = first; i < last; ++i) {
+                                     dst[i] *= kElem;
+                                   }
+                                 });
+  return *this;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::operator*(const T kElem) const {
+  DynamicMatrix copy = *this;
+  copy *= kElem;
+  return copy;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::operator*(const DynamicMatrix& obj) const {
+  if (cols_ != obj.rows_) {
+    throw std::invalid_argument("DynamicMatrix: dimension mismatch");
+  }
+  DynamicMatrix res(rows_, obj.cols_);
+  if (rows_ == cols_ && cols_ == obj.cols_) {
+    MatrixKernels::MultiplySquare(rows_, data(), cols_, obj.data(), obj.cols_,
+                                  res.data(), res.cols_);
+  } else {
+    MatrixKernels::Multiply(rows_, obj.cols_, cols_, data(), cols_,
+                            obj.data(), obj.cols_, res.data(), res.cols_);
+  }
+  return res;
+}
+
+template <typename T>
+DynamicMatrix<T> DynamicMatrix<T>::Transposed() const {
+  DynamicMatrix newmatrix(cols_, rows_);
+  MatrixKernels::Transpose(rows_, cols_, data(), cols_, newmatrix.data(),
+                           rows_);
+  return newmatrix;
+}
+
+template <typename T>
+bool DynamicMatrix<T>::operator==(const DynamicMatrix& obj) const {
+  return rows_ == obj.rows_ && cols_ == obj.cols_ &&
+         std::equal(data(), data() + rows_ * cols_, obj.data());
+}
+
+template <typename T>
+const T& DynamicMatrix<T>::operator()(const size_t kI, const size_t kJ) const {
+  return arr_.data()[kI * cols_ + kJ];
+}
+
+template <typename T>
+T& DynamicMatrix<T>::operator()(const size_t kI, const size_t kJ) {
+  return arr_.data()[kI * cols_ + kJ];
+}
+
+template <typename T>
+T DynamicMatrix<T>::Trace() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("DynamicMatrix: trace of non-square matrix");
+  }
+  T res{};
+  for (size_t i = 0; i < rows_; ++i) {
+    res += (*this)(i, i);
   }
   return res;
-}
\ No newline at end of file
+}